@@ -0,0 +1,143 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "vector.h"
+
+namespace ExposureRender
+{
+
+/*
+	Walker's alias table for drawing one of up to MAX_NO_LIGHTS discrete outcomes proportional to
+	their weights in constant time. Built on the host with Vose's method, sampled on the device
+*/
+class EXPOSURE_RENDER_DLL AliasTable
+{
+public:
+	HOST AliasTable() :
+		Count(0)
+	{
+		for (int i = 0; i < MAX_NO_LIGHTS; i++)
+		{
+			this->Probabilities[i]	= 1.0f;
+			this->Aliases[i]		= i;
+			this->Pdfs[i]			= 0.0f;
+		}
+	}
+
+	HOST ~AliasTable()
+	{
+	}
+
+	HOST AliasTable(const AliasTable& Other)
+	{
+		*this = Other;
+	}
+
+	HOST AliasTable& operator = (const AliasTable& Other)
+	{
+		for (int i = 0; i < MAX_NO_LIGHTS; i++)
+		{
+			this->Probabilities[i]	= Other.Probabilities[i];
+			this->Aliases[i]		= Other.Aliases[i];
+			this->Pdfs[i]			= Other.Pdfs[i];
+		}
+
+		this->Count = Other.Count;
+
+		return *this;
+	}
+
+	/*
+		Non-positive weights are never drawn, when all weights are non-positive the table falls back to uniform selection
+	*/
+	HOST void Build(const float* pWeights, const int& Count)
+	{
+		this->Count = Clamp(Count, 0, MAX_NO_LIGHTS);
+
+		float Sum = 0.0f;
+
+		for (int i = 0; i < this->Count; i++)
+			Sum += max(pWeights[i], 0.0f);
+
+		float Scaled[MAX_NO_LIGHTS];
+
+		int Small[MAX_NO_LIGHTS], Large[MAX_NO_LIGHTS];
+		int NoSmall = 0, NoLarge = 0;
+
+		for (int i = 0; i < this->Count; i++)
+		{
+			this->Pdfs[i]		= Sum > 0.0f ? max(pWeights[i], 0.0f) / Sum : 1.0f / (float)this->Count;
+			this->Aliases[i]	= i;
+
+			Scaled[i] = this->Pdfs[i] * (float)this->Count;
+
+			if (Scaled[i] < 1.0f)
+				Small[NoSmall++] = i;
+			else
+				Large[NoLarge++] = i;
+		}
+
+		while (NoSmall > 0 && NoLarge > 0)
+		{
+			const int S = Small[--NoSmall];
+			const int L = Large[--NoLarge];
+
+			this->Probabilities[S]	= Scaled[S];
+			this->Aliases[S]		= L;
+
+			Scaled[L] = (Scaled[L] + Scaled[S]) - 1.0f;
+
+			if (Scaled[L] < 1.0f)
+				Small[NoSmall++] = L;
+			else
+				Large[NoLarge++] = L;
+		}
+
+		// Whatever is left over only differs from one by round off
+		while (NoLarge > 0)
+			this->Probabilities[Large[--NoLarge]] = 1.0f;
+
+		while (NoSmall > 0)
+			this->Probabilities[Small[--NoSmall]] = 1.0f;
+	}
+
+	HOST_DEVICE int Sample(const float& U, float& Pdf) const
+	{
+		const float S	= U * (float)this->Count;
+		const int Bin	= min((int)S, this->Count - 1);
+		const int ID	= (S - (float)Bin) < this->Probabilities[Bin] ? Bin : this->Aliases[Bin];
+
+		Pdf = this->Pdfs[ID];
+
+		return ID;
+	}
+
+	HOST_DEVICE float Pdf(const int& ID) const
+	{
+		return this->Pdfs[ID];
+	}
+
+	float	Probabilities[MAX_NO_LIGHTS];
+	int		Aliases[MAX_NO_LIGHTS];
+	float	Pdfs[MAX_NO_LIGHTS];
+	int		Count;
+};
+
+}
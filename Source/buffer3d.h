@@ -197,6 +197,28 @@ public:
 		this->Dirty = true;
 	}
 
+	HOST void SetBox(const Vec3i& Min, const Vec3i& Max, T* Data)
+	{
+		DebugLog("%s: %s, [%d, %d, %d] - [%d, %d, %d]", __FUNCTION__, this->GetFullName(), Min[0], Min[1], Min[2], Max[0], Max[1], Max[2]);
+
+		const Vec3i Extent = Max - Min;
+
+		if (Extent[0] <= 0 || Extent[1] <= 0 || Extent[2] <= 0)
+			return;
+
+		if (this->MemoryType == Enums::Host)
+		{
+			for (int z = 0; z < Extent[2]; z++)
+				for (int y = 0; y < Extent[1]; y++)
+					memcpy(&(*this)(Min[0], Min[1] + y, Min[2] + z), &Data[(z * Extent[1] + y) * Extent[0]], Extent[0] * sizeof(T));
+		}
+
+#ifdef __CUDA_ARCH__
+		if (this->MemoryType == Enums::Device)
+			Cuda::MemCopyHostToDeviceBox(Data, this->Data, this->Resolution.D, Min.D, Extent.D);
+#endif
+	}
+
 	HOST_DEVICE int GetNoElements(void) const
 	{
 		return this->NoElements;
@@ -0,0 +1,106 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "macros.cuh"
+#include "volume.h"
+#include "tracer.h"
+
+namespace ExposureRender
+{
+
+KERNEL void KrnlClassify(const Volume* pVolume, unsigned char* pClassifiedVoxels, Vec3i Resolution, Vec3i Offset, Vec3i Extent, Range Window)
+{
+	KERNEL_3D(Extent[0], Extent[1], Extent[2])
+
+	const int X = Offset[0] + IDx;
+	const int Y = Offset[1] + IDy;
+	const int Z = Offset[2] + IDz;
+
+	pClassifiedVoxels[(Z * Resolution[1] + Y) * Resolution[0] + X] = (unsigned char)(Window.Normalize((float)pVolume->GetVoxel(X, Y, Z)) * 255.0f + 0.5f);
+}
+
+/*
+	Smallest intensity interval outside which the opacity function is zero, padded by one sample so
+	that intensities saturated to its bounds are still transparent
+*/
+Range ComputeClassificationWindow(const ScalarTransferFunction1D& Opacity1D, const Range& IntensityRange)
+{
+	const float Delta = IntensityRange.Extent / (float)(TF_NO_SAMPLES - 1);
+
+	int Bounds[2] = { TF_NO_SAMPLES, -1 };
+
+	for (int i = 0; i < TF_NO_SAMPLES; i++)
+	{
+		if (Opacity1D.Evaluate(IntensityRange.Min + (float)i * Delta) <= 0.0f)
+			continue;
+
+		Bounds[0] = min(Bounds[0], i);
+		Bounds[1] = max(Bounds[1], i);
+	}
+
+	if (Bounds[1] < 0)
+		return IntensityRange;
+
+	return Range(IntensityRange.Min + (float)max(Bounds[0] - 1, 0) * Delta, IntensityRange.Min + (float)min(Bounds[1] + 1, TF_NO_SAMPLES - 1) * Delta);
+}
+
+/*
+	Reclassifies the Extent voxels from Offset with the current window of the tracer
+*/
+void UpdateClassifiedVolume(Tracer& Tracer, const Volume& Volume, const Vec3i& Offset, const Vec3i& Extent)
+{
+	if (Tracer.ClassifiedVoxels.GetNoElements() <= 0)
+		return;
+
+	ExposureRender::Volume* pDeviceVolume = NULL;
+
+	Cuda::Allocate(pDeviceVolume);
+	Cuda::MemCopyHostToDevice(&Volume, pDeviceVolume);
+
+	LAUNCH_DIMENSIONS(Extent[0], Extent[1], Extent[2], 8, 8, 4)
+	LAUNCH_CUDA_KERNEL((KrnlClassify<<<GridDim, BlockDim>>>(pDeviceVolume, Tracer.ClassifiedVoxels.Data, Volume.Resolution, Offset, Extent, Tracer.ClassificationWindow)));
+
+	Cuda::Free(pDeviceVolume);
+}
+
+/*
+	Remaps the voxels inside the opacity window of the tracer to an 8-bit copy, saturated outside the
+	window, which the ray marchers sample at half the bandwidth of the full precision voxels
+*/
+void ComputeClassifiedVolume(Tracer& Tracer, const Volume& Volume)
+{
+	const Vec3i Resolution = Volume.Resolution;
+
+	if (!Tracer.RenderSettings.Traversal.WindowedClassification || Tracer.Opacity2D.Enabled() || Volume.SparseGrid.Enabled || Resolution[0] * Resolution[1] * Resolution[2] <= 0)
+	{
+		Tracer.ClassifiedVoxels.Free();
+		return;
+	}
+
+	Tracer.ClassificationWindow = ComputeClassificationWindow(Tracer.Opacity1D, Volume.IntensityRange);
+
+	DebugLog("%s, window = [%0.2f, %0.2f]", __FUNCTION__, Tracer.ClassificationWindow.Min, Tracer.ClassificationWindow.Max);
+
+	Tracer.ClassifiedVoxels.Resize(Resolution);
+
+	UpdateClassifiedVolume(Tracer, Volume, Vec3i(0), Resolution);
+}
+
+}
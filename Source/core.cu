@@ -45,7 +45,15 @@ ExposureRender::Cuda::List<ExposureRender::ClippingObject, ExposureRender::ErCli
 ExposureRender::Cuda::List<ExposureRender::Texture, ExposureRender::ErTexture>					gTextures("gpTextures");
 ExposureRender::Cuda::List<ExposureRender::Bitmap, ExposureRender::ErBitmap>					gBitmaps("gpBitmaps");
 
+#include "timeseries.cuh"
+#include "preintegration.cuh"
+#include "classification.cuh"
+
+map<int, ExposureRender::Cuda::TimeSeries*>														gTimeSeries;
+
 #include "singlescattering.cuh"
+#include "environment.cuh"
+#include "transmittancecache.cuh"
 #include "filterframeestimate.cuh"
 #include "estimate.cuh"
 #include "toneMap.cuh"
@@ -53,24 +61,388 @@ ExposureRender::Cuda::List<ExposureRender::Bitmap, ExposureRender::ErBitmap>
 namespace ExposureRender
 {
 
+/*
+	Rebuilds the transmittance cache of the tracer for its first MAX_NO_TRANSMITTANCE_CACHES area lights. The
+	environment has no position to march towards and is never cached. Unless Force is set, because the volume,
+	its classification or its labels changed, the cache is kept when its lights and shadow settings are unchanged
+*/
+void UpdateTransmittanceCache(Tracer& Tracer, const Volume& Volume, const bool& Force)
+{
+	int LightIDs[MAX_NO_TRANSMITTANCE_CACHES];
+	Vec3f LightPositions[MAX_NO_TRANSMITTANCE_CACHES];
+
+	int NoLights = 0;
+
+	const bool Enabled = Tracer.RenderSettings.Traversal.CacheTransmittance && Tracer.RenderSettings.Traversal.Shadows;
+
+	for (int i = 0; Enabled && i < Tracer.LightIDs.Count && NoLights < MAX_NO_TRANSMITTANCE_CACHES; i++)
+	{
+		if (!gLights.Exists(Tracer.LightIDs[i]))
+			continue;
+
+		const Light& Light = gLights[Tracer.LightIDs[i]];
+
+		if (Light.Type == Enums::Environment)
+			continue;
+
+		LightIDs[NoLights]			= Light.ID;
+		LightPositions[NoLights]	= TransformPoint(Light.Shape.TM, Vec3f(0.0f));
+
+		NoLights++;
+	}
+
+	if (!Force && Tracer.TransmittanceCache.Matches(LightIDs, LightPositions, NoLights, Tracer.RenderSettings.Shading.DensityScale, Tracer.RenderSettings.Traversal.StepFactorShadow, Tracer.RenderSettings.Traversal.MaxShadowDistance))
+		return;
+
+	Tracer.TransmittanceCache.Free();
+
+	if (NoLights <= 0)
+		return;
+
+	gTracers.Synchronize(Tracer.ID);
+
+	ComputeTransmittanceCache(Tracer, Volume, LightIDs, LightPositions, NoLights);
+}
+
+/*
+	Recomputes the tracer data that depends on both its opacity function and the volume it renders
+*/
+void UpdateOpacity(Tracer& Tracer, const Volume& Volume)
+{
+	ComputeVisibleBoundingBox(Tracer, Volume);
+	ComputePreIntegration(Tracer, Volume);
+	ComputeClassifiedVolume(Tracer, Volume);
+	UpdateTransmittanceCache(Tracer, Volume, true);
+}
+
+/*
+	Rebuilds the alias table that selects the lights of the tracer proportional to their power and the
+	hierarchy over their bounds. Lights that are not bound get zero power, they and the environment are
+	left out of the hierarchy
+*/
+void UpdateLights(Tracer& Tracer)
+{
+	float Powers[MAX_NO_LIGHTS];
+	Vec3f Min[MAX_NO_LIGHTS], Max[MAX_NO_LIGHTS];
+	int Indices[MAX_NO_LIGHTS];
+
+	const int NoLights = min(Tracer.LightIDs.Count, MAX_NO_LIGHTS);
+
+	int NoIndices = 0;
+
+	Tracer.EnvironmentLightID = -1;
+
+	for (int i = 0; i < NoLights; i++)
+	{
+		Powers[i]	= 0.0f;
+		Min[i]		= Vec3f(FLT_MAX);
+		Max[i]		= Vec3f(-FLT_MAX);
+
+		if (!gLights.Exists(Tracer.LightIDs[i]))
+			continue;
+
+		const Light& Light = gLights[Tracer.LightIDs[i]];
+
+		Powers[i] = Light.GetPower();
+
+		// The environment surrounds everything, it is never hit through the hierarchy
+		if (Light.Type == Enums::Environment)
+		{
+			if (Tracer.EnvironmentLightID < 0)
+				Tracer.EnvironmentLightID = Tracer.LightIDs[i];
+
+			continue;
+		}
+
+		Light.Shape.GetBounds(Min[i], Max[i]);
+
+		Indices[NoIndices++] = i;
+	}
+
+	Tracer.LightDistribution.Build(Powers, NoLights);
+	Tracer.LightBVH.Build(Indices, NoIndices, Min, Max);
+}
+
+/*
+	Rebuilds the importance sampling distribution of an environment light from the bitmap of its texture
+*/
+void UpdateEnvironment(Light& Light)
+{
+	if (Light.Type != Enums::Environment || !gTextures.Exists(Light.TextureID))
+	{
+		Light.Distribution.Free();
+		return;
+	}
+
+	const Texture& Texture = gTextures[Light.TextureID];
+
+	if (Texture.Type != Enums::Bitmap || !gBitmaps.Exists(Texture.BitmapID))
+	{
+		Light.Distribution.Free();
+		return;
+	}
+
+	ComputeEnvironmentDistribution(Light.Distribution, gBitmaps[Texture.BitmapID].Pixels);
+}
+
+void UpdateLights()
+{
+	for (map<int, Tracer*>::iterator It = gTracers.Map.begin(); It != gTracers.Map.end(); It++)
+	{
+		UpdateLights(*It->second);
+
+		if (gVolumes.Exists(It->second->VolumeID))
+			UpdateTransmittanceCache(*It->second, gVolumes[It->second->VolumeID], false);
+	}
+}
+
 EXPOSURE_RENDER_DLL void BindTracer(const ErTracer& Tracer, const bool& Bind /*= true*/)
 {
 	DebugLog("%s, Bind = %s", __FUNCTION__, Bind ? "true" : "false");
 	
 	if (Bind)
+	{
+		bool OpacityChanged = true, LabelsChanged = true;
+
+		if (gTracers.Exists(Tracer.ID))
+		{
+			const ExposureRender::Tracer& Current = gTracers[Tracer.ID];
+
+			OpacityChanged	= !(Current.Opacity1D == Tracer.Opacity1D) || !(Current.Opacity2D == Tracer.Opacity2D) || Current.VolumeID != Tracer.VolumeID || Current.RenderSettings.Traversal.WindowedClassification != Tracer.RenderSettings.Traversal.WindowedClassification;
+			// Label opacities scale the extinction the cache was marched through, new labels are dirty until bound
+			LabelsChanged	= Current.LabelVolumeID != Tracer.LabelVolumeID || Tracer.Labels.Dirty;
+		}
+
 		gTracers.Bind(Tracer);
+
+		if (gTracers.Exists(Tracer.ID))
+			UpdateLights(gTracers[Tracer.ID]);
+
+		if (OpacityChanged && gTracers.Exists(Tracer.ID) && gVolumes.Exists(Tracer.VolumeID))
+			UpdateOpacity(gTracers[Tracer.ID], gVolumes[Tracer.VolumeID]);
+		else if (gTracers.Exists(Tracer.ID) && gVolumes.Exists(Tracer.VolumeID))
+			UpdateTransmittanceCache(gTracers[Tracer.ID], gVolumes[Tracer.VolumeID], LabelsChanged);
+	}
 	else
+	{
 		gTracers.Unbind(Tracer);
+	}
+}
+
+EXPOSURE_RENDER_DLL void UpdateTracer(const ErTracer& Tracer, int Changes)
+{
+	DebugLog("%s, Changes = %d", __FUNCTION__, Changes);
+
+	if (!gTracers.Exists(Tracer.ID))
+	{
+		char Message[MAX_CHAR_SIZE];
+
+		sprintf_s(Message, MAX_CHAR_SIZE, "%s failed, tracer with ID:%d does not exist, bind it first", __FUNCTION__, Tracer.ID);
+
+		throw(Exception(Enums::Warning, Message));
+	}
+
+	ExposureRender::Tracer& Target = gTracers[Tracer.ID];
+
+	const bool VolumeChanged	= (Changes & Enums::SceneChanged) && Target.VolumeID != Tracer.VolumeID;
+	const bool WindowChanged	= (Changes & Enums::RenderSettingsChanged) && Target.RenderSettings.Traversal.WindowedClassification != Tracer.RenderSettings.Traversal.WindowedClassification;
+	const bool LabelsChanged	= (Changes & Enums::LabelsChanged) || ((Changes & Enums::SceneChanged) && Target.LabelVolumeID != Tracer.LabelVolumeID);
+
+	Target.Update(Tracer, Changes);
+
+	if (Changes & Enums::LightsChanged)
+		UpdateLights(Target);
+
+	if (((Changes & Enums::OpacityChanged) || VolumeChanged || WindowChanged) && gVolumes.Exists(Target.VolumeID))
+		UpdateOpacity(Target, gVolumes[Target.VolumeID]);
+	else if (((Changes & (Enums::LightsChanged | Enums::RenderSettingsChanged)) || LabelsChanged) && gVolumes.Exists(Target.VolumeID))
+		UpdateTransmittanceCache(Target, gVolumes[Target.VolumeID], LabelsChanged);
+
+	gTracers.Synchronize();
+}
+
+/*
+	Restarts progressive rendering of the tracers that sample a volume, as their estimates were accumulated
+	from its old voxels
+*/
+void ResetTracers(const int& VolumeID)
+{
+	for (map<int, Tracer*>::iterator It = gTracers.Map.begin(); It != gTracers.Map.end(); It++)
+	{
+		if (It->second->VolumeID == VolumeID || It->second->LabelVolumeID == VolumeID)
+			It->second->NoIterations = 0;
+	}
+}
+
+/*
+	Refreshes the tracers that render a volume after its voxels changed, tracers that only use it as their label
+	volume just rebuild their transmittance cache, as label opacities scale the extinction
+*/
+void UpdateTracers(const int& VolumeID)
+{
+	ResetTracers(VolumeID);
+
+	for (map<int, Tracer*>::iterator It = gTracers.Map.begin(); It != gTracers.Map.end(); It++)
+	{
+		if (It->second->VolumeID == VolumeID)
+			UpdateOpacity(*It->second, gVolumes[VolumeID]);
+		else if (It->second->LabelVolumeID == VolumeID && gVolumes.Exists(It->second->VolumeID))
+			UpdateTransmittanceCache(*It->second, gVolumes[It->second->VolumeID], true);
+	}
+}
+
+/*
+	Refreshes the tracer data after the voxels in [Min, Max) of a volume changed while its ranges did not,
+	the pre-integration and classification window only depend on the ranges and stay valid
+*/
+void UpdateTracers(const int& VolumeID, const Vec3i& Min, const Vec3i& Max)
+{
+	Vec3i RegionMin, RegionMax;
+
+	GetPreprocessRegion(gVolumes[VolumeID].Resolution, Min, Max, RegionMin, RegionMax);
+
+	ResetTracers(VolumeID);
+
+	for (map<int, Tracer*>::iterator It = gTracers.Map.begin(); It != gTracers.Map.end(); It++)
+	{
+		if (It->second->LabelVolumeID == VolumeID && It->second->VolumeID != VolumeID && gVolumes.Exists(It->second->VolumeID))
+			UpdateTransmittanceCache(*It->second, gVolumes[It->second->VolumeID], true);
+
+		if (It->second->VolumeID != VolumeID)
+			continue;
+
+		ComputeVisibleBoundingBox(*It->second, gVolumes[VolumeID]);
+		UpdateClassifiedVolume(*It->second, gVolumes[VolumeID], RegionMin, RegionMax - RegionMin);
+		UpdateTransmittanceCache(*It->second, gVolumes[VolumeID], true);
+	}
 }
 
 EXPOSURE_RENDER_DLL void BindVolume(const ErVolume& Volume, const bool& Bind /*= true*/)
 {
 	DebugLog("%s, Bind = %s", __FUNCTION__, Bind ? "true" : "false");
 
+	bool LaterTimepoint = false;
+
+	if (gTimeSeries.find(Volume.ID) != gTimeSeries.end())
+	{
+		LaterTimepoint = gTimeSeries[Volume.ID]->Timepoint != 0;
+
+		delete gTimeSeries[Volume.ID];
+		gTimeSeries.erase(Volume.ID);
+	}
+
 	if (Bind)
+	{
+		// The bound voxels may hold a later timepoint than the host voxels, which are then uploaded again
+		if (LaterTimepoint)
+			Volume.Voxels.Dirty = true;
+
 		gVolumes.Bind(Volume);
+
+		if (gVolumes.Exists(Volume.ID))
+		{
+			PreprocessVolume(gVolumes[Volume.ID]);
+			gVolumes.Synchronize();
+
+			UpdateTracers(Volume.ID);
+		}
+	}
 	else
+	{
 		gVolumes.Unbind(Volume);
+	}
+
+	if (Bind && Volume.NoTimepoints > 1 && !Volume.Sparse && gVolumes.Exists(Volume.ID))
+	{
+		Cuda::TimeSeries* pTimeSeries = new Cuda::TimeSeries(Volume);
+
+		gTimeSeries[Volume.ID] = pTimeSeries;
+
+		pTimeSeries->Prefetch(gVolumes[Volume.ID], pTimeSeries->GetNextTimepoint(0));
+	}
+}
+
+EXPOSURE_RENDER_DLL void SetTimepoint(int VolumeID, int Timepoint)
+{
+	DebugLog("%s, VolumeID = %d, Timepoint = %d", __FUNCTION__, VolumeID, Timepoint);
+
+	if (gTimeSeries.find(VolumeID) == gTimeSeries.end())
+	{
+		char Message[MAX_CHAR_SIZE];
+
+		sprintf_s(Message, MAX_CHAR_SIZE, "%s failed, volume with ID:%d is not a time series", __FUNCTION__, VolumeID);
+
+		throw(Exception(Enums::Warning, Message));
+	}
+
+	Cuda::TimeSeries& TimeSeries = *gTimeSeries[VolumeID];
+
+	Timepoint = Clamp(Timepoint, 0, TimeSeries.NoTimepoints - 1);
+
+	TimeSeries.Swap(gVolumes.Map[VolumeID], Timepoint);
+
+	gVolumes.Synchronize();
+
+	UpdateTracers(VolumeID);
+
+	TimeSeries.Prefetch(gVolumes[VolumeID], TimeSeries.GetNextTimepoint(Timepoint));
+}
+
+EXPOSURE_RENDER_DLL void UpdateVoxels(int VolumeID, const Vec3i& Min, const Vec3i& Max, unsigned short* pVoxels)
+{
+	DebugLog("%s, VolumeID = %d", __FUNCTION__, VolumeID);
+
+	Volume& Volume = gVolumes[VolumeID];
+
+	if (Volume.SparseGrid.Enabled)
+	{
+		char Message[MAX_CHAR_SIZE];
+
+		sprintf_s(Message, MAX_CHAR_SIZE, "%s failed, volume with ID:%d is sparse, rebind it instead", __FUNCTION__, VolumeID);
+
+		throw(Exception(Enums::Warning, Message));
+	}
+
+	const Vec3i Resolution = Volume.Resolution;
+
+	if (Min[0] < 0 || Min[1] < 0 || Min[2] < 0 || Max[0] > Resolution[0] || Max[1] > Resolution[1] || Max[2] > Resolution[2] || !(Min < Max))
+	{
+		char Message[MAX_CHAR_SIZE];
+
+		sprintf_s(Message, MAX_CHAR_SIZE, "%s failed, box [%d, %d, %d] - [%d, %d, %d] is not inside volume with ID:%d", __FUNCTION__, Min[0], Min[1], Min[2], Max[0], Max[1], Max[2], VolumeID);
+
+		throw(Exception(Enums::Warning, Message));
+	}
+
+	const bool RangesChanged = PreprocessRegion(Volume, Min, Max, pVoxels);
+
+	gVolumes.Synchronize();
+
+	if (RangesChanged)
+		UpdateTracers(VolumeID);
+	else
+		UpdateTracers(VolumeID, Min, Max);
+}
+
+EXPOSURE_RENDER_DLL void GetIntensityRange(int VolumeID, float& Min, float& Max)
+{
+	const Range& IntensityRange = gVolumes[VolumeID].IntensityRange;
+
+	Min = IntensityRange.Min;
+	Max = IntensityRange.Max;
+}
+
+EXPOSURE_RENDER_DLL void GetGradientMagnitudeRange(int VolumeID, float& Min, float& Max)
+{
+	const Range& GradientMagnitudeRange = gVolumes[VolumeID].GradientMagnitudeRange;
+
+	Min = GradientMagnitudeRange.Min;
+	Max = GradientMagnitudeRange.Max;
+}
+
+EXPOSURE_RENDER_DLL void GetHistogram(int VolumeID, int* pBins)
+{
+	memcpy(pBins, gVolumes[VolumeID].Histogram, NO_HISTOGRAM_BINS * sizeof(int));
 }
 
 EXPOSURE_RENDER_DLL void BindLight(const ErLight& Light, const bool& Bind /*= true*/)
@@ -81,6 +453,14 @@ EXPOSURE_RENDER_DLL void BindLight(const ErLight& Light, const bool& Bind /*= tr
 		gLights.Bind(Light);
 	else
 		gLights.Unbind(Light);
+
+	if (Bind && gLights.Exists(Light.ID))
+	{
+		UpdateEnvironment(gLights[Light.ID]);
+		gLights.Synchronize();
+	}
+
+	UpdateLights();
 }
 
 EXPOSURE_RENDER_DLL void BindObject(const ErObject& Object, const bool& Bind /*= true*/)
@@ -111,6 +491,17 @@ EXPOSURE_RENDER_DLL void BindTexture(const ErTexture& Texture, const bool& Bind
 		gTextures.Bind(Texture);
 	else
 		gTextures.Unbind(Texture);
+
+	// The distribution of an environment light describes the bitmap its texture references
+	for (map<int, Light*>::iterator It = gLights.Map.begin(); It != gLights.Map.end(); It++)
+	{
+		if (It->second->Type == Enums::Environment && It->second->TextureID == Texture.ID)
+			UpdateEnvironment(*It->second);
+	}
+
+	gLights.Synchronize();
+
+	UpdateLights();
 }
 
 EXPOSURE_RENDER_DLL void BindBitmap(const ErBitmap& Bitmap, const bool& Bind /*= true*/)
@@ -121,6 +512,17 @@ EXPOSURE_RENDER_DLL void BindBitmap(const ErBitmap& Bitmap, const bool& Bind /*=
 		gBitmaps.Bind(Bitmap);
 	else
 		gBitmaps.Unbind(Bitmap);
+
+	// Environment lights sample their bitmap, so their distributions follow it
+	for (map<int, Light*>::iterator It = gLights.Map.begin(); It != gLights.Map.end(); It++)
+	{
+		if (It->second->Type == Enums::Environment)
+			UpdateEnvironment(*It->second);
+	}
+
+	gLights.Synchronize();
+
+	UpdateLights();
 }
 
 EXPOSURE_RENDER_DLL void RenderEstimate(int TracerID)
@@ -45,6 +45,7 @@ namespace ExposureRender
 	#define HOST_DEVICE					HOST DEVICE 
 	#define HOST_DEVICE_NI				HOST_DEVICE __noinline__
 	#define CD							__device__ __constant__
+	#define ALIGN(Bytes)				__align__(Bytes)
 #else
 	#define KERNEL
 	#define HOST
@@ -53,6 +54,7 @@ namespace ExposureRender
 	#define HOST_DEVICE
 	#define HOST_DEVICE_NI
 	#define CD
+	#define ALIGN(Bytes)				__declspec(align(Bytes))
 #endif
 
 #define PI_F						3.141592654f	
@@ -64,6 +66,10 @@ namespace ExposureRender
 #define FOUR_PI_F					4.0f * PI_F
 #define INV_FOUR_PI_F				1.0f / FOUR_PI_F
 #define	EULER_F						2.718281828f
+#define LN_2_F						0.69314718056f
+#define LOG2_E_F					1.44269504089f
+#define SQRT_2_F					1.41421356237f
+#define INV_SQRT_2_F				0.70710678119f
 #define RAD_F						57.29577951308232f
 #define TWO_RAD_F					2.0f * RAD_F
 #define DEG_TO_RAD					1.0f / RAD_F
@@ -75,6 +81,20 @@ namespace ExposureRender
 #define	MAX_CHAR_SIZE				256
 #define MAX_NO_TF_NODES				128
 #define NO_COLOR_COMPONENTS			4
+#define MAX_NO_TIMEPOINTS			64
+#define NO_HISTOGRAM_BINS			256
+#define TF_NO_SAMPLES				512
+#define MAX_NO_LABELS				65536
+#define MAX_NO_LIGHTS				256
+#define MAX_NO_TF2D_BOXES			16
+#define TF2D_NO_SAMPLES				64
+#define MATERIAL_NO_SAMPLES			1024
+#define PREINTEGRATION_NO_SAMPLES	256
+#define MACROCELL_SIZE				8
+#define SPARSE_BRICK_SIZE			8
+#define SPARSE_NODE_SIZE			16
+#define TRANSMITTANCE_CACHE_REDUCTION	4
+#define MAX_NO_TRANSMITTANCE_CACHES	4
 
 	/*
 
@@ -0,0 +1,157 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "buffer2d.h"
+
+namespace ExposureRender
+{
+
+/*
+	Piecewise constant 2D distribution over the unit square, sampled with a marginal distribution over the
+	rows and a conditional distribution per row. Func holds the unnormalized function per cell, the CDFs
+	are normalized and Integral is the mean of Func. A distribution that has not been built samples uniformly
+*/
+class EXPOSURE_RENDER_DLL Distribution2D
+{
+public:
+	HOST Distribution2D() :
+		Resolution(0),
+		Integral(0.0f),
+		Func(Enums::Device, "Distribution Function"),
+		ConditionalCdf(Enums::Device, "Distribution Conditional CDF"),
+		RowIntegrals(Enums::Device, "Distribution Row Integrals"),
+		MarginalCdf(Enums::Device, "Distribution Marginal CDF")
+	{
+	}
+
+	HOST ~Distribution2D()
+	{
+	}
+
+	HOST Distribution2D(const Distribution2D& Other) :
+		Resolution(0),
+		Integral(0.0f),
+		Func(Enums::Device, "Distribution Function"),
+		ConditionalCdf(Enums::Device, "Distribution Conditional CDF"),
+		RowIntegrals(Enums::Device, "Distribution Row Integrals"),
+		MarginalCdf(Enums::Device, "Distribution Marginal CDF")
+	{
+		*this = Other;
+	}
+
+	HOST Distribution2D& operator = (const Distribution2D& Other)
+	{
+		this->Resolution		= Other.Resolution;
+		this->Integral			= Other.Integral;
+		this->Func				= Other.Func;
+		this->ConditionalCdf	= Other.ConditionalCdf;
+		this->RowIntegrals		= Other.RowIntegrals;
+		this->MarginalCdf		= Other.MarginalCdf;
+
+		return *this;
+	}
+
+	HOST void Free(void)
+	{
+		this->Resolution	= Vec2i(0);
+		this->Integral		= 0.0f;
+
+		this->Func.Free();
+		this->ConditionalCdf.Free();
+		this->RowIntegrals.Free();
+		this->MarginalCdf.Free();
+	}
+
+	/*
+		Returns a point in the unit square distributed according to Func and its density with respect to the unit square
+	*/
+	HOST_DEVICE Vec2f Sample(const Vec2f& U, float& Pdf) const
+	{
+		if (this->Integral <= 0.0f)
+		{
+			Pdf = 1.0f;
+			return U;
+		}
+
+		const int W = this->Resolution[0];
+		const int H = this->Resolution[1];
+
+		const int Y = FindInterval(this->MarginalCdf.Data, H + 1, U[1]);
+
+		const float* pCdf = &this->ConditionalCdf.Data[Y * (W + 1)];
+
+		const int X = FindInterval(pCdf, W + 1, U[0]);
+
+		const float DU = Offset(pCdf, X, U[0]);
+		const float DV = Offset(this->MarginalCdf.Data, Y, U[1]);
+
+		Pdf = this->Func.Data[Y * W + X] / this->Integral;
+
+		return Vec2f(((float)X + DU) / (float)W, ((float)Y + DV) / (float)H);
+	}
+
+	HOST_DEVICE float Pdf(const Vec2f& UV) const
+	{
+		if (this->Integral <= 0.0f)
+			return 1.0f;
+
+		const int X = Clamp((int)(UV[0] * (float)this->Resolution[0]), 0, this->Resolution[0] - 1);
+		const int Y = Clamp((int)(UV[1] * (float)this->Resolution[1]), 0, this->Resolution[1] - 1);
+
+		return this->Func.Data[Y * this->Resolution[0] + X] / this->Integral;
+	}
+
+	Vec2i				Resolution;
+	float				Integral;
+	Buffer2D<float>		Func;
+	Buffer2D<float>		ConditionalCdf;
+	Buffer2D<float>		RowIntegrals;
+	Buffer2D<float>		MarginalCdf;
+
+private:
+	/*
+		Largest index i in [0, Size - 2] for which pCdf[i] <= U
+	*/
+	HOST_DEVICE static int FindInterval(const float* pCdf, const int& Size, const float& U)
+	{
+		int First = 0, Last = Size - 2;
+
+		while (First < Last)
+		{
+			const int Mid = (First + Last + 1) / 2;
+
+			if (pCdf[Mid] <= U)
+				First = Mid;
+			else
+				Last = Mid - 1;
+		}
+
+		return First;
+	}
+
+	HOST_DEVICE static float Offset(const float* pCdf, const int& ID, const float& U)
+	{
+		const float Delta = pCdf[ID + 1] - pCdf[ID];
+
+		return Delta > 0.0f ? Clamp((U - pCdf[ID]) / Delta, 0.0f, 1.0f) : 0.0f;
+	}
+};
+
+}
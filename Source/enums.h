@@ -75,6 +75,7 @@ namespace Enums
 		ForwardDifferences = 0,
 		CentralDifferences,
 		Filtered,
+		Cached
 	};
 
 	enum ExceptionLevel
@@ -85,6 +86,12 @@ namespace Enums
 		Fatal
 	};
 
+	enum LightType
+	{
+		Area = 0,
+		Environment
+	};
+
 	enum EmissionUnit
 	{
 		Power = 0,
@@ -105,6 +112,41 @@ namespace Enums
 		Object,
 		SlicePlane
 	};
+
+	enum ShadingVariant
+	{
+		DiffuseShading	= 0x00,
+		SpecularShading	= 0x01,
+		EmissiveShading	= 0x02,
+		PhaseShading	= 0x04,
+		HybridShading	= 0x08
+	};
+
+	enum RenderVariant
+	{
+		ShadowsVariant		= 0x10,
+		ApertureVariant		= 0x20,
+		WavefrontVariant	= 0x40
+	};
+
+	enum TracerChange
+	{
+		OpacityChanged			= 0x01,
+		ColorChanged			= 0x02,
+		CameraChanged			= 0x04,
+		LightsChanged			= 0x08,
+		RenderSettingsChanged	= 0x10,
+		SceneChanged			= 0x20,
+		LabelsChanged			= 0x40,
+		AllChanged				= 0x7f
+	};
+
+	enum MathAccuracy
+	{
+		ExactMath = 0,
+		PreciseMath,
+		FastMath
+	};
 }
 
 }
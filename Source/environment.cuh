@@ -0,0 +1,113 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "macros.cuh"
+#include "distribution2d.h"
+
+#include <vector>
+
+namespace ExposureRender
+{
+
+/*
+	Luminance of each texel of an equirectangular environment map, weighted by the sine of its polar angle
+	to account for the stretching of the rows towards the poles
+*/
+KERNEL void KrnlComputeEnvironmentFunction(const ColorRGBAuc* pPixels, float* pFunc, Vec2i Resolution)
+{
+	KERNEL_2D(Resolution[0], Resolution[1])
+
+	const float SinTheta = sinf(PI_F * ((float)IDy + 0.5f) / (float)Resolution[1]);
+
+	pFunc[IDk] = ColorXYZf::FromRGBAuc(pPixels[IDk]).Y() * SinTheta;
+}
+
+/*
+	One thread per row, accumulates the conditional CDF of the row and stores the mean of its function values
+*/
+KERNEL void KrnlComputeConditionalCdfs(const float* pFunc, float* pConditionalCdf, float* pRowIntegrals, Vec2i Resolution)
+{
+	KERNEL_1D(Resolution[1])
+
+	const int W = Resolution[0];
+
+	const float* pRow	= &pFunc[IDx * W];
+	float* pCdf			= &pConditionalCdf[IDx * (W + 1)];
+
+	pCdf[0] = 0.0f;
+
+	for (int i = 0; i < W; i++)
+		pCdf[i + 1] = pCdf[i] + pRow[i] / (float)W;
+
+	const float Integral = pCdf[W];
+
+	for (int i = 1; i <= W; i++)
+		pCdf[i] = Integral > 0.0f ? pCdf[i] / Integral : (float)i / (float)W;
+
+	pRowIntegrals[IDx] = Integral;
+}
+
+/*
+	Builds the marginal and conditional distributions of an environment map on the device, only the marginal
+	CDF over the rows is accumulated on the host
+*/
+void ComputeEnvironmentDistribution(Distribution2D& Distribution, const Buffer2D<ColorRGBAuc>& Pixels)
+{
+	const Vec2i Resolution = Pixels.Resolution;
+
+	if (Resolution[0] * Resolution[1] <= 0)
+	{
+		Distribution.Free();
+		return;
+	}
+
+	Distribution.Resolution = Resolution;
+
+	Distribution.Func.Resize(Resolution);
+	Distribution.ConditionalCdf.Resize(Vec2i(Resolution[0] + 1, Resolution[1]));
+	Distribution.RowIntegrals.Resize(Vec2i(Resolution[1], 1));
+	Distribution.MarginalCdf.Resize(Vec2i(Resolution[1] + 1, 1));
+
+	{
+		LAUNCH_DIMENSIONS(Resolution[0], Resolution[1], 1, 16, 8, 1)
+		LAUNCH_CUDA_KERNEL((KrnlComputeEnvironmentFunction<<<GridDim, BlockDim>>>(Pixels.Data, Distribution.Func.Data, Resolution)));
+	}
+
+	{
+		LAUNCH_DIMENSIONS(Resolution[1], 1, 1, 128, 1, 1)
+		LAUNCH_CUDA_KERNEL((KrnlComputeConditionalCdfs<<<GridDim, BlockDim>>>(Distribution.Func.Data, Distribution.ConditionalCdf.Data, Distribution.RowIntegrals.Data, Resolution)));
+	}
+
+	vector<float> RowIntegrals(Resolution[1]), MarginalCdf(Resolution[1] + 1, 0.0f);
+
+	Cuda::MemCopyDeviceToHost(Distribution.RowIntegrals.Data, &RowIntegrals[0], Resolution[1]);
+
+	for (int i = 0; i < Resolution[1]; i++)
+		MarginalCdf[i + 1] = MarginalCdf[i] + RowIntegrals[i] / (float)Resolution[1];
+
+	Distribution.Integral = MarginalCdf[Resolution[1]];
+
+	for (int i = 1; i <= Resolution[1]; i++)
+		MarginalCdf[i] = Distribution.Integral > 0.0f ? MarginalCdf[i] / Distribution.Integral : (float)i / (float)Resolution[1];
+
+	Cuda::MemCopyHostToDevice(&MarginalCdf[0], Distribution.MarginalCdf.Data, Resolution[1] + 1);
+}
+
+}
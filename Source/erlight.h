@@ -29,6 +29,7 @@ class EXPOSURE_RENDER_DLL ErLight : public ErBindable
 public:
 	HOST ErLight() :
 		ErBindable(),
+		Type(Enums::Area),
 		Visible(),
 		TextureID(-1),
 		Multiplier(0.0f),
@@ -49,6 +50,7 @@ public:
 	{
 		ErBindable::operator=(Other);
 
+		this->Type			= Other.Type;
 		this->Visible		= Other.Visible;
 		this->Shape			= Other.Shape;
 		this->TextureID		= Other.TextureID;
@@ -58,6 +60,7 @@ public:
 		return *this;
 	}
 
+	Enums::LightType		Type;
 	bool					Visible;
 	Shape					Shape;
 	int						TextureID;
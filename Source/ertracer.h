@@ -20,6 +20,8 @@
 
 #include "erbindable.h"
 #include "transferfunction.h"
+#include "label.h"
+#include "buffer3d.h"
 #include "camera.h"
 #include "rendersettings.h"
 
@@ -40,10 +42,14 @@ public:
 		Specular1D(),
 		Glossiness1D(),
 		Emission1D(),
+		Opacity2D(),
+		Diffuse2D(),
 		Camera(),
 		RenderSettings(),
 		NoIterations(0),
 		VolumeID(0),
+		LabelVolumeID(-1),
+		Labels(Enums::Host, "Host Labels"),
 		LightIDs(),
 		ObjectIDs(),
 		ClippingObjectIDs()
@@ -54,7 +60,8 @@ public:
 	{
 	}
 	
-	HOST ErTracer(const ErTracer& Other)
+	HOST ErTracer(const ErTracer& Other) :
+		Labels(Enums::Host, "Host Labels")
 	{
 		*this = Other;
 	}
@@ -68,10 +75,15 @@ public:
 		this->Specular1D			= Other.Specular1D;
 		this->Glossiness1D			= Other.Glossiness1D;
 		this->Emission1D			= Other.Emission1D;
+		this->Opacity2D				= Other.Opacity2D;
+		this->Diffuse2D				= Other.Diffuse2D;
 		this->Camera				= Other.Camera;
 		this->RenderSettings		= Other.RenderSettings;
 		this->NoIterations			= Other.NoIterations;
 		this->VolumeID				= Other.VolumeID;
+		this->LabelVolumeID			= Other.LabelVolumeID;
+		this->Labels				= Other.Labels;
+
 		this->LightIDs				= Other.LightIDs;
 		this->ObjectIDs				= Other.ObjectIDs;
 		this->ClippingObjectIDs		= Other.ClippingObjectIDs;
@@ -79,6 +91,15 @@ public:
 		return *this;
 	}
 	
+	/*
+		Copies the appearance of the labels 0 to NoLabels - 1, so the table covers the full 16-bit range of a label volume
+		when needed. Labels without an entry are shown unmodified
+	*/
+	HOST void SetLabels(Label* pLabels, const int& NoLabels)
+	{
+		this->Labels.Set(Enums::Host, Vec3i(Clamp(NoLabels, 0, MAX_NO_LABELS), 1, 1), pLabels);
+	}
+
 	HOST void BindIDs(Indices SourceIDs, Indices& TargetIDs, map<int, int> HashMap)
 	{
 		for (int i = 0; i < SourceIDs.Count; i++)
@@ -107,10 +128,14 @@ public:
 	ColorTransferFunction1D		Specular1D;
 	ScalarTransferFunction1D	Glossiness1D;
 	ColorTransferFunction1D		Emission1D;
+	ScalarTransferFunction2D	Opacity2D;
+	ColorTransferFunction2D		Diffuse2D;
 	Camera						Camera;
 	RenderSettings				RenderSettings;
 	int							NoIterations;
 	int							VolumeID;
+	int							LabelVolumeID;
+	Buffer3D<Label>				Labels;
 	Indices						LightIDs;
 	Indices						ObjectIDs;
 	Indices						ClippingObjectIDs;
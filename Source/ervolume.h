@@ -32,7 +32,11 @@ public:
 		ErBindable(),
 		Voxels(Enums::Host, "Host Voxels"),
 		NormalizeSize(false),
-		Spacing(1.0f)
+		Spacing(1.0f),
+		NoTimepoints(0),
+		Sparse(false),
+		Background(0),
+		CacheGradients(false)
 	{
 	}
 
@@ -44,7 +48,11 @@ public:
 		ErBindable(),
 		Voxels(Enums::Host, "Host Voxels"),
 		NormalizeSize(false),
-		Spacing(1.0f)
+		Spacing(1.0f),
+		NoTimepoints(0),
+		Sparse(false),
+		Background(0),
+		CacheGradients(false)
 	{
 		*this = Other;
 	}
@@ -56,6 +64,14 @@ public:
 		this->Voxels		= Other.Voxels;
 		this->NormalizeSize	= Other.NormalizeSize;
 		this->Spacing		= Other.Spacing;
+		this->NoTimepoints	= Other.NoTimepoints;
+
+		for (int i = 0; i < this->NoTimepoints; i++)
+			this->Timepoints[i] = Other.Timepoints[i];
+
+		this->Sparse		= Other.Sparse;
+		this->Background		= Other.Background;
+		this->CacheGradients	= Other.CacheGradients;
 
 		return *this;
 	}
@@ -66,11 +82,31 @@ public:
 
 		this->NormalizeSize	= NormalizeSize;
 		this->Spacing		= Spacing;
+		this->NoTimepoints	= 0;
+	}
+
+	/*
+		Binds a time series, all timepoints share the same resolution and spacing. The voxel
+		data of the timepoints is not copied, the caller must keep it alive while the volume is bound
+	*/
+	HOST void BindTimepoints(const Vec3i& Resolution, const Vec3f& Spacing, unsigned short** ppVoxels, const int& NoTimepoints, const bool& NormalizeSize = false)
+	{
+		this->BindVoxels(Resolution, Spacing, ppVoxels[0], NormalizeSize);
+
+		this->NoTimepoints = min(NoTimepoints, MAX_NO_TIMEPOINTS);
+
+		for (int i = 0; i < this->NoTimepoints; i++)
+			this->Timepoints[i] = ppVoxels[i];
 	}
 
 	Buffer3D<unsigned short>	Voxels;
 	bool						NormalizeSize;
 	Vec3f						Spacing;
+	unsigned short*				Timepoints[MAX_NO_TIMEPOINTS];
+	int							NoTimepoints;
+	bool						Sparse;
+	unsigned short				Background;
+	bool						CacheGradients;
 };
 
 }
@@ -30,7 +30,13 @@ namespace ExposureRender
 {
 
 EXPOSURE_RENDER_DLL void BindTracer(const ErTracer& Tracer, const bool& Bind = true);
+EXPOSURE_RENDER_DLL void UpdateTracer(const ErTracer& Tracer, int Changes = Enums::AllChanged);
 EXPOSURE_RENDER_DLL void BindVolume(const ErVolume& Volume, const bool& Bind = true);
+EXPOSURE_RENDER_DLL void UpdateVoxels(int VolumeID, const Vec3i& Min, const Vec3i& Max, unsigned short* pVoxels);
+EXPOSURE_RENDER_DLL void GetIntensityRange(int VolumeID, float& Min, float& Max);
+EXPOSURE_RENDER_DLL void GetGradientMagnitudeRange(int VolumeID, float& Min, float& Max);
+EXPOSURE_RENDER_DLL void GetHistogram(int VolumeID, int* pBins);
+EXPOSURE_RENDER_DLL void SetTimepoint(int VolumeID, int Timepoint);
 EXPOSURE_RENDER_DLL void BindLight(const ErLight& Light, const bool& Bind = true);
 EXPOSURE_RENDER_DLL void BindObject(const ErObject& Object, const bool& Bind = true);
 EXPOSURE_RENDER_DLL void BindClippingObject(const ErClippingObject& ClippingObject, const bool& Bind = true);
@@ -0,0 +1,136 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "defines.h"
+#include "enums.h"
+
+#include <math.h>
+
+namespace ExposureRender
+{
+
+/*
+	Transcendental functions with selectable accuracy. The exact tier calls the math library, the
+	precise tier has a relative error of about 1e-4 and the fast tier of about 1e-2. The approximations
+	are branch free polynomials after range reduction, so neighbouring threads stay in lock step
+*/
+
+HOST_DEVICE float Exp2(const float& X, const int& Accuracy)
+{
+	if (Accuracy == Enums::ExactMath)
+		return exp2f(X);
+
+	const float Clamped	= fminf(fmaxf(X, -126.0f), 126.0f);
+	const float N		= floorf(Clamped);
+	const float G		= (Clamped - N - 0.5f) * LN_2_F;
+
+	// e^G on [-ln(2) / 2, ln(2) / 2], multiplied by sqrt(2) to undo the half step shift
+	float P;
+
+	if (Accuracy == Enums::PreciseMath)
+		P = 1.0f + G * (1.0f + G * (0.5f + G * (1.0f / 6.0f + G * (1.0f / 24.0f))));
+	else
+		P = 1.0f + G * (1.0f + G * 0.5f);
+
+	return ldexpf(SQRT_2_F * P, (int)N);
+}
+
+HOST_DEVICE float Exp(const float& X, const int& Accuracy)
+{
+	if (Accuracy == Enums::ExactMath)
+		return expf(X);
+
+	return Exp2(X * LOG2_E_F, Accuracy);
+}
+
+HOST_DEVICE float Log(const float& X, const int& Accuracy)
+{
+	if (Accuracy == Enums::ExactMath)
+		return logf(X);
+
+	int E;
+
+	float M = frexpf(X, &E);
+
+	// Center the mantissa on one, so that |T| < 0.172
+	if (M < INV_SQRT_2_F)
+	{
+		M *= 2.0f;
+		E--;
+	}
+
+	const float T	= (M - 1.0f) / (M + 1.0f);
+	const float T2	= T * T;
+
+	float P;
+
+	if (Accuracy == Enums::PreciseMath)
+		P = 2.0f * T * (1.0f + T2 * (1.0f / 3.0f + T2 * (1.0f / 5.0f)));
+	else
+		P = 2.0f * T;
+
+	return (float)E * LN_2_F + P;
+}
+
+/*
+	Power of a non-negative base, returns zero for bases that are not positive
+*/
+HOST_DEVICE float Pow(const float& X, const float& Y, const int& Accuracy)
+{
+	if (Accuracy == Enums::ExactMath)
+		return powf(X, Y);
+
+	if (X <= 0.0f)
+		return 0.0f;
+
+	return Exp(Y * Log(X, Accuracy), Accuracy);
+}
+
+HOST_DEVICE float Sin(const float& X, const int& Accuracy)
+{
+	if (Accuracy == Enums::ExactMath)
+		return sinf(X);
+
+	// Reduce to [-pi, pi] and fold onto [-pi / 2, pi / 2]
+	float R = X - TWO_PI_F * rintf(X * INV_TWO_PI_F);
+
+	if (R > HALF_PI_F)
+		R = PI_F - R;
+
+	if (R < -HALF_PI_F)
+		R = -PI_F - R;
+
+	const float R2 = R * R;
+
+	if (Accuracy == Enums::PreciseMath)
+		return R * (1.0f + R2 * (-1.0f / 6.0f + R2 * (1.0f / 120.0f + R2 * (-1.0f / 5040.0f + R2 * (1.0f / 362880.0f)))));
+
+	return R * (1.0f + R2 * (-1.0f / 6.0f + R2 * (1.0f / 120.0f)));
+}
+
+HOST_DEVICE float Cos(const float& X, const int& Accuracy)
+{
+	if (Accuracy == Enums::ExactMath)
+		return cosf(X);
+
+	return Sin(X + HALF_PI_F, Accuracy);
+}
+
+}
@@ -25,9 +25,9 @@
 namespace ExposureRender
 {
 
-HOST_DEVICE_NI float Gauss2D(const float& Sigma, const int& X, const int& Y)
+HOST_DEVICE_NI float Gauss2D(const float& Sigma, const int& X, const int& Y, const int& Accuracy = Enums::ExactMath)
 {
-	return expf(-((X * X + Y * Y) / (2 * Sigma * Sigma)));
+	return Exp(-((X * X + Y * Y) / (2 * Sigma * Sigma)), Accuracy);
 }
 
 KERNEL void KrnlFilterFrameEstimate(int KernelRadius, float Sigma)
@@ -49,7 +49,7 @@ KERNEL void KrnlFilterFrameEstimate(int KernelRadius, float Sigma)
 	{
 		for (int x = Range[0][0]; x <= Range[0][1]; x++)
 		{
-			Weight		= Gauss2D(Sigma, x - IDx, y - IDy);
+			Weight		= Gauss2D(Sigma, x - IDx, y - IDy, gpTracer->RenderSettings.Shading.MathAccuracy);
 			Sum			+= gpTracer->FrameBuffer.FrameEstimate(x, y) * Weight;
 			TotalWeight	+= Weight;
 		}
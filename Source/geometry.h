@@ -51,20 +51,26 @@ HOST_DEVICE inline Vec3f TransformPoint(const Matrix44& TM, const Vec3f& P)
 	return Vec3f(Px, Py, Pz);
 }
 
-HOST_DEVICE inline Ray TransformRay(const Matrix44& TM, const Ray& R)
+/*
+	Transforms the origin and direction of R by the affine matrix TM. The direction is renormalized and
+	the parametric range scaled along, Scale converts a parametric distance along the transformed ray
+	back to one along R
+*/
+HOST_DEVICE inline Ray TransformRay(const Matrix44& TM, const Ray& R, float& Scale)
 {
-	Ray Rt;
+	const Vec3f D = TransformVector(TM, R.D);
 
-	Vec3f P		= TransformPoint(TM, R.O);
-	Vec3f MinP	= TransformPoint(TM, R(R.MinT));
-	Vec3f MaxP	= TransformPoint(TM, R(R.MaxT));
+	Scale = D.Length();
 
-	Rt.O	= P;
-	Rt.D	= Normalize(MaxP - Rt.O);
-	Rt.MinT	= (MinP - Rt.O).Length();
-	Rt.MaxT	= (MaxP - Rt.O).Length();
+	const float InvScale = 1.0f / Scale;
 
-	return Rt;
+	return Ray(TransformPoint(TM, R.O), D * InvScale, R.MinT * Scale, R.MaxT * Scale);
+}
+
+HOST_DEVICE inline Ray TransformRay(const Matrix44& TM, const Ray& R)
+{
+	float Scale = 1.0f;
+	return TransformRay(TM, R, Scale);
 }
 
 HOST_DEVICE inline float SphericalTheta(const Vec3f& W)
@@ -18,56 +18,54 @@
 
 #pragma once
 
-#include "geometry.h"
-
-#include <thrust/reduce.h>
+#include "macros.cuh"
+#include "statistics.cuh"
 
 namespace ExposureRender
 {
 
-KERNEL void KrnlComputeGradientMagnitudeVolume(unsigned short* pGradientMagnitude, int Width, int Height, int Depth)
+/*
+	Caches the gradient magnitude of each voxel, quantized to 16 bits over the gradient magnitude
+	range of the volume, so that classification costs a single fetch instead of six intensity lookups.
+	Only the Extent voxels from Offset are updated
+*/
+KERNEL void KrnlComputeGradientMagnitudeVolume(const Volume* pVolume, unsigned short* pGradientMagnitudes, Vec3i Resolution, Vec3i Offset, Vec3i Extent, Range GradientMagnitudeRange)
 {
-	/*
-	const int X = blockIdx.x * blockDim.x + threadIdx.x;
-	const int Y	= blockIdx.y * blockDim.y + threadIdx.y;
-	const int Z	= blockIdx.z * blockDim.z + threadIdx.z;
-	
-	if (X >= Width || Y >= Height || Z >= Depth)
-		return;
-	
-	const Vec3f P = gpTracer->Volume.MinAABB + gpTracer->Volume.Size * (Vec3f((float)X + 0.5f, (float)Y + 0.5f, (float)Z + 0.5f) * gpTracer->Volume.InvResolution);
+	KERNEL_3D(Extent[0], Extent[1], Extent[2])
 
-	int ID = X + Y * Width + Z * (Width * Height);
+	const int X = Offset[0] + IDx;
+	const int Y = Offset[1] + IDy;
+	const int Z = Offset[2] + IDz;
 
-	pGradientMagnitude[ID] = GradientMagnitude(P);
-	*/
+	pGradientMagnitudes[(Z * Resolution[1] + Y) * Resolution[0] + X] = (unsigned short)(GradientMagnitudeRange.Normalize(VoxelGradientMagnitude(*pVolume, X, Y, Z)) * 65535.0f + 0.5f);
 }
 
-void ComputeGradientMagnitudeVolume(int Extent[3], float& MaximumGradientMagnitude)
+void UpdateGradientMagnitudeVolume(Volume& Volume, const ExposureRender::Volume* pDeviceVolume, const Vec3i& Offset, const Vec3i& Extent)
 {
-	const dim3 BlockDim(8, 8, 8);
-	const dim3 GridDim((int)ceilf((float)Extent[0] / (float)BlockDim.x), (int)ceilf((float)Extent[1] / (float)BlockDim.y), (int)ceilf((float)Extent[2] / (float)BlockDim.z));
+	if (Volume.GradientMagnitudes.GetNoElements() <= 0)
+		return;
 
-	unsigned short* pGradientMagnitude = NULL;
+	LAUNCH_DIMENSIONS(Extent[0], Extent[1], Extent[2], 8, 8, 4)
+	LAUNCH_CUDA_KERNEL((KrnlComputeGradientMagnitudeVolume<<<GridDim, BlockDim>>>(pDeviceVolume, Volume.GradientMagnitudes.Data, Volume.Resolution, Offset, Extent, Volume.GradientMagnitudeRange)));
+}
 
-	// Allocate temporary linear memory for computation
-	Cuda::Allocate(pGradientMagnitude, Extent[0] * Extent[1] * Extent[2]);
+void ComputeGradientMagnitudeVolume(Volume& Volume, const ExposureRender::Volume* pDeviceVolume)
+{
+	// A dense cache would defeat the purpose of sparse volumes, they compute gradient magnitudes on the fly
+	if (Volume.SparseGrid.Enabled)
+	{
+		Volume.GradientMagnitudes.Free();
+		return;
+	}
 
-	// Execute gradient computation kernel
-	LAUNCH_CUDA_KERNEL((KrnlComputeGradientMagnitudeVolume<<<GridDim, BlockDim>>>(pGradientMagnitude, Extent[0], Extent[1], Extent[2])));
-	
-	// Create thrust device pointer
-	thrust::device_ptr<unsigned short> DevicePtr(pGradientMagnitude); 
+	const Vec3i Resolution = Volume.Resolution;
 
-	// Reduce the volume to a maximum gradient magnitude
-	float Result = 0.0f;
-	Result = thrust::reduce(DevicePtr, DevicePtr + Extent[0] * Extent[1] * Extent[2], Result, thrust::maximum<unsigned short>());
-	
-	// Free temporary memory
-	Cuda::Free(pGradientMagnitude);
+	if (Resolution[0] * Resolution[1] * Resolution[2] <= 0)
+		return;
 
-	// Set result
-	MaximumGradientMagnitude = Result;
+	Volume.GradientMagnitudes.Resize(Resolution);
+
+	UpdateGradientMagnitudeVolume(Volume, pDeviceVolume, Vec3i(0), Resolution);
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,101 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "macros.cuh"
+#include "statistics.cuh"
+
+namespace ExposureRender
+{
+
+/*
+	Caches the gradient of each voxel in 32 bits, the direction as a 16 bit octahedral normal in the
+	low bits and the magnitude quantized to 8 bits over the gradient magnitude range above it. Follows
+	the sign convention of the on the fly gradients, which point towards decreasing intensity. Only the
+	Extent voxels from Offset are updated
+*/
+KERNEL void KrnlComputeGradientVolume(const Volume* pVolume, unsigned int* pGradients, Vec3i Resolution, Vec3i Offset, Vec3i Extent, Range GradientMagnitudeRange)
+{
+	KERNEL_3D(Extent[0], Extent[1], Extent[2])
+
+	const int X = Offset[0] + IDx;
+	const int Y = Offset[1] + IDy;
+	const int Z = Offset[2] + IDz;
+
+	Vec3f G(((float)pVolume->GetVoxel(X - 1, Y, Z) - (float)pVolume->GetVoxel(X + 1, Y, Z)) * 0.5f * pVolume->InvSpacing[0],
+			((float)pVolume->GetVoxel(X, Y - 1, Z) - (float)pVolume->GetVoxel(X, Y + 1, Z)) * 0.5f * pVolume->InvSpacing[1],
+			((float)pVolume->GetVoxel(X, Y, Z - 1) - (float)pVolume->GetVoxel(X, Y, Z + 1)) * 0.5f * pVolume->InvSpacing[2]);
+
+	const float L1 = fabsf(G[0]) + fabsf(G[1]) + fabsf(G[2]);
+
+	const float Magnitude = sqrtf(G[0] * G[0] + G[1] * G[1] + G[2] * G[2]);
+
+	float U = 0.0f, V = 0.0f;
+
+	if (L1 > 0.0f)
+	{
+		U = G[0] / L1;
+		V = G[1] / L1;
+
+		if (G[2] < 0.0f)
+		{
+			const float FoldedU = (1.0f - fabsf(V)) * (U >= 0.0f ? 1.0f : -1.0f);
+			const float FoldedV = (1.0f - fabsf(U)) * (V >= 0.0f ? 1.0f : -1.0f);
+
+			U = FoldedU;
+			V = FoldedV;
+		}
+	}
+
+	const unsigned int QU = (unsigned int)((U * 0.5f + 0.5f) * 255.0f + 0.5f);
+	const unsigned int QV = (unsigned int)((V * 0.5f + 0.5f) * 255.0f + 0.5f);
+	const unsigned int QM = (unsigned int)(GradientMagnitudeRange.Normalize(Magnitude) * 255.0f + 0.5f);
+
+	pGradients[(Z * Resolution[1] + Y) * Resolution[0] + X] = QU | (QV << 8) | (QM << 16);
+}
+
+void UpdateGradientVolume(Volume& Volume, const ExposureRender::Volume* pDeviceVolume, const Vec3i& Offset, const Vec3i& Extent)
+{
+	if (Volume.Gradients.GetNoElements() <= 0)
+		return;
+
+	LAUNCH_DIMENSIONS(Extent[0], Extent[1], Extent[2], 8, 8, 4)
+	LAUNCH_CUDA_KERNEL((KrnlComputeGradientVolume<<<GridDim, BlockDim>>>(pDeviceVolume, Volume.Gradients.Data, Volume.Resolution, Offset, Extent, Volume.GradientMagnitudeRange)));
+}
+
+void ComputeGradientVolume(Volume& Volume, const ExposureRender::Volume* pDeviceVolume)
+{
+	// Sparse volumes compute gradients on the fly, a dense cache would defeat their purpose
+	if (!Volume.CacheGradients || Volume.SparseGrid.Enabled)
+	{
+		Volume.Gradients.Free();
+		return;
+	}
+
+	const Vec3i Resolution = Volume.Resolution;
+
+	if (Resolution[0] * Resolution[1] * Resolution[2] <= 0)
+		return;
+
+	Volume.Gradients.Resize(Resolution);
+
+	UpdateGradientVolume(Volume, pDeviceVolume, Vec3i(0), Resolution);
+}
+
+}
@@ -0,0 +1,71 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "color.h"
+
+namespace ExposureRender
+{
+
+/*
+	Appearance of one segment of a label volume, its opacity and diffuse color scale those of the
+	intensity transfer functions
+*/
+class EXPOSURE_RENDER_DLL Label
+{
+public:
+	HOST Label() :
+		Visible(true),
+		Opacity(1.0f),
+		Diffuse(1.0f)
+	{
+	}
+
+	HOST Label(const bool& Visible, const float& Opacity, const ColorXYZf& Diffuse) :
+		Visible(Visible),
+		Opacity(Opacity),
+		Diffuse(Diffuse)
+	{
+	}
+
+	HOST Label(const Label& Other)
+	{
+		*this = Other;
+	}
+
+	HOST Label& operator = (const Label& Other)
+	{
+		this->Visible	= Other.Visible;
+		this->Opacity	= Other.Opacity;
+		this->Diffuse	= Other.Diffuse;
+
+		return *this;
+	}
+
+	HOST_DEVICE float GetOpacity() const
+	{
+		return this->Visible ? this->Opacity : 0.0f;
+	}
+
+	bool		Visible;
+	float		Opacity;
+	ColorXYZf	Diffuse;
+};
+
+}
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "erlight.h"
+#include "distribution2d.h"
 
 namespace ExposureRender
 {
@@ -27,11 +28,14 @@ class Light : public ErLight
 {
 public:
 	HOST Light() :
-		ErLight()
+		ErLight(),
+		Distribution()
 	{
 	}
 
-	HOST Light(const ErLight& Other)
+	HOST Light(const ErLight& Other) :
+		ErLight(),
+		Distribution()
 	{
 		*this = Other;
 	}
@@ -43,6 +47,23 @@ public:
 
 		return *this;
 	}
+
+	/*
+		Emitted power up to a constant factor, used to importance sample the lights. Texture modulation is ignored
+	*/
+	HOST float GetPower() const
+	{
+		// Rough equivalent for the environment, its mean luminance over the sphere
+		if (this->Type == Enums::Environment)
+			return this->Multiplier * FOUR_PI_F * (this->Distribution.Integral > 0.0f ? this->Distribution.Integral : 1.0f);
+
+		if (this->Unit == Enums::Lux)
+			return this->Multiplier;
+
+		return this->Multiplier * this->Shape.Area;
+	}
+
+	Distribution2D Distribution;
 };
 
 }
@@ -0,0 +1,211 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+
+namespace ExposureRender
+{
+
+#define MAX_NO_LIGHT_BVH_NODES		(2 * MAX_NO_LIGHTS)
+#define LIGHT_BVH_LEAF_SIZE			2
+#define LIGHT_BVH_STACK_SIZE		32
+
+class EXPOSURE_RENDER_DLL LightBVHNode
+{
+public:
+	HOST LightBVHNode() :
+		Min(FLT_MAX),
+		Max(-FLT_MAX),
+		Offset(0),
+		Count(0),
+		Axis(0)
+	{
+	}
+
+	/*
+		Slab test of the ray O + t * D against the bounds of the node, InvD holds the reciprocal direction
+	*/
+	HOST_DEVICE bool Intersects(const Vec3f& O, const Vec3f& InvD, const float& MinT, const float& MaxT) const
+	{
+		const Vec3f BottomT	= InvD * (this->Min - O);
+		const Vec3f TopT	= InvD * (this->Max - O);
+		const Vec3f NearT	= TopT.Min(BottomT);
+		const Vec3f FarT	= TopT.Max(BottomT);
+
+		const float LargestNearT	= fmaxf(fmaxf(NearT[0], NearT[1]), fmaxf(NearT[2], MinT));
+		const float SmallestFarT	= fminf(fminf(FarT[0], FarT[1]), fminf(FarT[2], MaxT));
+
+		return LargestNearT <= SmallestFarT;
+	}
+
+	Vec3f	Min;
+	Vec3f	Max;
+	int		Offset;
+	int		Count;
+	int		Axis;
+};
+
+/*
+	Orders light indices by the centroid coordinate of the lights along Axis
+*/
+class EXPOSURE_RENDER_DLL CentroidLess
+{
+public:
+	HOST CentroidLess(const Vec3f* pCentroids, const int& Axis) :
+		pCentroids(pCentroids),
+		Axis(Axis)
+	{
+	}
+
+	HOST bool operator()(const int& A, const int& B) const
+	{
+		return this->pCentroids[A][this->Axis] < this->pCentroids[B][this->Axis];
+	}
+
+	const Vec3f*	pCentroids;
+	int				Axis;
+};
+
+/*
+	Bounding volume hierarchy over the lights of a tracer. Nodes are stored depth first, the left child of an
+	interior node directly follows it and Offset points to its right child, split along Axis. Leaves (Count > 0) reference Count
+	consecutive entries of LightIndices, which are indices into the tracer's LightIDs
+*/
+class EXPOSURE_RENDER_DLL LightBVH
+{
+public:
+	HOST LightBVH() :
+		NoNodes(0)
+	{
+		for (int i = 0; i < MAX_NO_LIGHTS; i++)
+			this->LightIndices[i] = i;
+	}
+
+	HOST ~LightBVH()
+	{
+	}
+
+	HOST LightBVH(const LightBVH& Other)
+	{
+		*this = Other;
+	}
+
+	HOST LightBVH& operator = (const LightBVH& Other)
+	{
+		this->NoNodes = Other.NoNodes;
+
+		for (int i = 0; i < Other.NoNodes; i++)
+			this->Nodes[i] = Other.Nodes[i];
+
+		for (int i = 0; i < MAX_NO_LIGHTS; i++)
+			this->LightIndices[i] = Other.LightIndices[i];
+
+		return *this;
+	}
+
+	/*
+		Builds the hierarchy over the Count lights in pIndices by median splits along the longest centroid axis, pMin and
+		pMax hold the world space bounds of all lights of the tracer and are indexed by light index. Lights that are not in
+		pIndices are never referenced by a leaf
+	*/
+	HOST void Build(const int* pIndices, const int& Count, const Vec3f* pMin, const Vec3f* pMax)
+	{
+		this->NoNodes = 0;
+
+		const int NoLights = Clamp(Count, 0, MAX_NO_LIGHTS);
+
+		if (NoLights <= 0)
+			return;
+
+		Vec3f Centroids[MAX_NO_LIGHTS];
+
+		for (int i = 0; i < NoLights; i++)
+		{
+			const int ID = pIndices[i];
+
+			this->LightIndices[i]	= ID;
+			Centroids[ID]			= 0.5f * (pMin[ID] + pMax[ID]);
+		}
+
+		this->BuildNode(0, NoLights, pMin, pMax, Centroids);
+	}
+
+	LightBVHNode	Nodes[MAX_NO_LIGHT_BVH_NODES];
+	int				NoNodes;
+	int				LightIndices[MAX_NO_LIGHTS];
+
+private:
+	HOST int BuildNode(const int& Start, const int& End, const Vec3f* pMin, const Vec3f* pMax, const Vec3f* pCentroids)
+	{
+		const int NodeID = this->NoNodes++;
+
+		LightBVHNode& Node = this->Nodes[NodeID];
+
+		Node = LightBVHNode();
+
+		Vec3f CentroidMin(FLT_MAX), CentroidMax(-FLT_MAX);
+
+		for (int i = Start; i < End; i++)
+		{
+			const int ID = this->LightIndices[i];
+
+			Node.Min	= Node.Min.Min(pMin[ID]);
+			Node.Max	= Node.Max.Max(pMax[ID]);
+			CentroidMin	= CentroidMin.Min(pCentroids[ID]);
+			CentroidMax	= CentroidMax.Max(pCentroids[ID]);
+		}
+
+		if (End - Start <= LIGHT_BVH_LEAF_SIZE)
+		{
+			Node.Offset	= Start;
+			Node.Count	= End - Start;
+
+			return NodeID;
+		}
+
+		const Vec3f Extent = CentroidMax - CentroidMin;
+
+		int Axis = 0;
+
+		if (Extent[1] > Extent[Axis])
+			Axis = 1;
+
+		if (Extent[2] > Extent[Axis])
+			Axis = 2;
+
+		const int Mid = (Start + End) / 2;
+
+		std::nth_element(&this->LightIndices[Start], &this->LightIndices[Mid], &this->LightIndices[0] + End, CentroidLess(pCentroids, Axis));
+
+		this->BuildNode(Start, Mid, pMin, pMax, pCentroids);
+
+		const int Right = this->BuildNode(Mid, End, pMin, pMax, pCentroids);
+
+		this->Nodes[NodeID].Offset	= Right;
+		this->Nodes[NodeID].Count	= 0;
+		this->Nodes[NodeID].Axis	= Axis;
+
+		return NodeID;
+	}
+};
+
+}
@@ -41,12 +41,81 @@ HOST_DEVICE_NI void SampleLightSurface(const Light& Light, LightSample& LS, Surf
 	SS.N = TransformVector(Light.Shape.TM, SS.N);
 }
 
-HOST_DEVICE_NI void SampleLight(const Light& Light, LightSample& LS, SurfaceSample& SS, ScatterEvent& SE, Vec3f& Wi, ColorXYZf& Le)
+/*
+	Radiance of an environment light at equirectangular coordinate UV. Bitmaps are looked up directly, nearest
+	texel, so that the radiance is constant over the cells of the sampling distribution, which ignores texture
+	offset and repeat
+*/
+HOST_DEVICE ColorXYZf EvaluateEnvironment(const Light& Light, const Vec2f& UV)
+{
+	if (Light.TextureID >= 0 && gpTextures[Light.TextureID].Type == Enums::Bitmap && gpTextures[Light.TextureID].BitmapID >= 0)
+	{
+		const Buffer2D<ColorRGBAuc>& Pixels = gpBitmaps[gpTextures[Light.TextureID].BitmapID].Pixels;
+
+		const int X = Clamp((int)(UV[0] * (float)Pixels.Resolution[0]), 0, Pixels.Resolution[0] - 1);
+		const int Y = Clamp((int)(UV[1] * (float)Pixels.Resolution[1]), 0, Pixels.Resolution[1] - 1);
+
+		return ColorXYZf::FromRGBAuc(Pixels.Data[Y * Pixels.Resolution[0] + X]) * (Light.Multiplier * gpTextures[Light.TextureID].OutputLevel);
+	}
+
+	return EvaluateTexture(Light.TextureID, UV) * Light.Multiplier;
+}
+
+/*
+	Radiance arriving from the environment along world space direction W, false if the tracer has no visible environment light
+*/
+HOST_DEVICE_NI bool EnvironmentRadiance(const Vec3f& W, ColorXYZf& Le)
+{
+	if (gpTracer->EnvironmentLightID < 0)
+		return false;
+
+	const Light& Light = gpLights[gpTracer->EnvironmentLightID];
+
+	if (!Light.Visible)
+		return false;
+
+	const Vec3f Wl = Normalize(TransformVector(Light.Shape.InvTM, W));
+
+	Le = EvaluateEnvironment(Light, Vec2f(SphericalPhi(Wl) * INV_TWO_PI_F, SphericalTheta(Wl) * INV_PI_F));
+
+	return true;
+}
+
+/*
+	Samples a point on Light as seen from SE, Pdf is the density of the sample with respect to solid angle at SE.
+	Environment lights are importance sampled with their 2D distribution, the sample is placed at the maximum
+	shadow distance so that visibility is tested over the same range as for area lights
+*/
+HOST_DEVICE_NI void SampleLight(const Light& Light, LightSample& LS, SurfaceSample& SS, ScatterEvent& SE, Vec3f& Wi, ColorXYZf& Le, float& Pdf)
 {
+	if (Light.Type == Enums::Environment)
+	{
+		float MapPdf = 0.0f;
+
+		const Vec2f UV = Light.Distribution.Sample(Vec2f(LS.SurfaceUVW[0], LS.SurfaceUVW[1]), MapPdf);
+
+		const float Theta		= UV[1] * PI_F;
+		const float Phi			= UV[0] * TWO_PI_F;
+		const float SinTheta	= sinf(Theta);
+
+		Wi = Normalize(TransformVector(Light.Shape.TM, Vec3f(SinTheta * cosf(Phi), cosf(Theta), SinTheta * sinf(Phi))));
+
+		SS.P	= SE.P + gpTracer->RenderSettings.Traversal.MaxShadowDistance * Wi;
+		SS.N	= -Wi;
+		SS.UV	= UV;
+
+		Pdf	= SinTheta > 0.0f ? MapPdf / (2.0f * PI_F * PI_F * SinTheta) : 0.0f;
+		Le	= EvaluateEnvironment(Light, UV);
+
+		return;
+	}
+
 	SampleLightSurface(Light, LS, SS);
 
 	Wi = Normalize(SS.P - SE.P);
 
+	Pdf = DistanceSquared(SE.P, SS.P) / (AbsDot(SS.N, -Wi) * Light.Shape.Area);
+
 	Le = Light.Multiplier * EvaluateTexture(Light.TextureID, SS.UV);
 	
 	if (Light.Shape.OneSided && Dot(SE.P - SS.P, SS.N) < 0.0f)
@@ -58,7 +127,9 @@ HOST_DEVICE_NI void SampleLight(const Light& Light, LightSample& LS, SurfaceSamp
 
 HOST_DEVICE_NI void IntersectLight(const Light& Light, const Ray& R, ScatterEvent& SE)
 {
-	Ray Rt = TransformRay(Light.Shape.InvTM, R);
+	float Scale = 1.0f;
+
+	const Ray Rt = TransformRay(Light.Shape.InvTM, R, Scale);
 
 	Intersection Int;
 
@@ -77,7 +148,7 @@ HOST_DEVICE_NI void IntersectLight(const Light& Light, const Ray& R, ScatterEven
 		SE.Valid	= true;
 		SE.P 		= TransformPoint(Light.Shape.TM, Int.P);
 		SE.N 		= TransformVector(Light.Shape.TM, Int.N);
-		SE.T 		= Length(SE.P - R.O);
+		SE.T 		= Int.NearT / Scale;
 		SE.Wo		= -R.D;
 		SE.UV		= Int.UV;
 		SE.Le		= Int.Front ? Light.Multiplier * EvaluateTexture(Light.TextureID, SE.UV) : ColorXYZf::Black();
@@ -87,27 +158,64 @@ HOST_DEVICE_NI void IntersectLight(const Light& Light, const Ray& R, ScatterEven
 	}
 }
 
+/*
+	Nearest light hit along R, found by traversing the light hierarchy of the tracer front to back and
+	culling nodes beyond the nearest hit so far. The child on the near side of the split is popped first
+*/
 HOST_DEVICE_NI void IntersectLights(const Ray& R, ScatterEvent& RS, bool RespectVisibility = false)
 {
+	const LightBVH& BVH = gpTracer->LightBVH;
+
+	if (BVH.NoNodes <= 0)
+		return;
+
+	const Vec3f InvD = Vec3f(1.0f, 1.0f, 1.0f) / R.D;
+
 	float T = FLT_MAX; 
 
-	for (int i = 0; i < gpTracer->LightIDs.Count; i++)
+	int Stack[LIGHT_BVH_STACK_SIZE];
+	int NoStack = 0;
+
+	Stack[NoStack++] = 0;
+
+	while (NoStack > 0)
 	{
-		const Light& Light = gpLights[gpTracer->LightIDs[i]];
-		
-		ScatterEvent LocalRS(Enums::Light);
+		const int NodeID = Stack[--NoStack];
 
-		LocalRS.LightID = i;
+		const LightBVHNode& Node = BVH.Nodes[NodeID];
 
-		if (RespectVisibility && !Light.Visible)
+		if (!Node.Intersects(R.O, InvD, R.MinT, fminf(T, R.MaxT)))
 			continue;
 
-		IntersectLight(Light, R, LocalRS);
+		if (Node.Count <= 0)
+		{
+			const bool LeftFirst = R.D[Node.Axis] >= 0.0f;
 
-		if (LocalRS.Valid && LocalRS.T < T)
+			Stack[NoStack++] = LeftFirst ? Node.Offset : NodeID + 1;
+			Stack[NoStack++] = LeftFirst ? NodeID + 1 : Node.Offset;
+			continue;
+		}
+
+		for (int j = 0; j < Node.Count; j++)
 		{
-			RS = LocalRS;
-			T = LocalRS.T;
+			const int i = BVH.LightIndices[Node.Offset + j];
+
+			const Light& Light = gpLights[gpTracer->LightIDs[i]];
+		
+			ScatterEvent LocalRS(Enums::Light);
+
+			LocalRS.LightID = i;
+
+			if (RespectVisibility && !Light.Visible)
+				continue;
+
+			IntersectLight(Light, R, LocalRS);
+
+			if (LocalRS.Valid && LocalRS.T < T)
+			{
+				RS = LocalRS;
+				T = LocalRS.T;
+			}
 		}
 	}
 }
@@ -117,14 +225,44 @@ HOST_DEVICE_NI bool IntersectsLight(const Light& Light, const Ray& R)
 	return IntersectsShape(Light.Shape, TransformRay(Light.Shape.InvTM, R));
 }
 
+/*
+	Any hit query against the light hierarchy of the tracer, stops at the first light R hits
+*/
 HOST_DEVICE_NI bool IntersectsLight(const Ray& R)
 {
-	for (int i = 0; i < gpTracer->LightIDs.Count; i++)
+	const LightBVH& BVH = gpTracer->LightBVH;
+
+	if (BVH.NoNodes <= 0)
+		return false;
+
+	const Vec3f InvD = Vec3f(1.0f, 1.0f, 1.0f) / R.D;
+
+	int Stack[LIGHT_BVH_STACK_SIZE];
+	int NoStack = 0;
+
+	Stack[NoStack++] = 0;
+
+	while (NoStack > 0)
 	{
-		const Light& Light = gpLights[gpTracer->LightIDs[i]];
+		const int NodeID = Stack[--NoStack];
+
+		const LightBVHNode& Node = BVH.Nodes[NodeID];
 
-		if (IntersectsLight(Light, R))
-			return true;
+		if (!Node.Intersects(R.O, InvD, R.MinT, R.MaxT))
+			continue;
+
+		if (Node.Count <= 0)
+		{
+			Stack[NoStack++] = Node.Offset;
+			Stack[NoStack++] = NodeID + 1;
+			continue;
+		}
+
+		for (int j = 0; j < Node.Count; j++)
+		{
+			if (IntersectsLight(gpLights[gpTracer->LightIDs[BVH.LightIndices[Node.Offset + j]]], R))
+				return true;
+		}
 	}
 
 	return false;
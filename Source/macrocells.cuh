@@ -0,0 +1,156 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "macros.cuh"
+#include "volume.h"
+#include "tracer.h"
+
+namespace ExposureRender
+{
+
+/*
+	Each macrocell stores the intensity range of MACROCELL_SIZE^3 voxels, including the voxels
+	one beyond its upper faces so that trilinear lookups inside the cell are covered as well. Only the
+	Extent macrocells from Offset are updated
+*/
+KERNEL void KrnlComputeMacrocells(const Volume* pVolume, Vec2f* pMacrocells, Vec3i MacrocellResolution, Vec3i Offset, Vec3i Extent)
+{
+	KERNEL_3D(Extent[0], Extent[1], Extent[2])
+
+	const Vec3i Resolution = pVolume->Resolution;
+
+	const int X = Offset[0] + IDx;
+	const int Y = Offset[1] + IDy;
+	const int Z = Offset[2] + IDz;
+
+	const int Min[3] = { X * MACROCELL_SIZE, Y * MACROCELL_SIZE, Z * MACROCELL_SIZE };
+	const int Max[3] = { min(Min[0] + MACROCELL_SIZE, Resolution[0] - 1), min(Min[1] + MACROCELL_SIZE, Resolution[1] - 1), min(Min[2] + MACROCELL_SIZE, Resolution[2] - 1) };
+
+	unsigned short Range[2] = { 0xffff, 0 };
+
+	for (int z = Min[2]; z <= Max[2]; z++)
+	{
+		for (int y = Min[1]; y <= Max[1]; y++)
+		{
+			for (int x = Min[0]; x <= Max[0]; x++)
+			{
+				const unsigned short Intensity = pVolume->GetVoxel(x, y, z);
+
+				Range[0] = min(Range[0], Intensity);
+				Range[1] = max(Range[1], Intensity);
+			}
+		}
+	}
+
+	pMacrocells[(Z * MacrocellResolution[1] + Y) * MacrocellResolution[0] + X] = Vec2f((float)Range[0], (float)Range[1]);
+}
+
+KERNEL void KrnlComputeVisibleBounds(const Vec2f* pMacrocells, Vec3i MacrocellResolution, const Tracer* pTracer, int* pBounds)
+{
+	KERNEL_3D(MacrocellResolution[0], MacrocellResolution[1], MacrocellResolution[2])
+
+	if (pTracer->GetMaximumOpacity(pMacrocells[IDk][0], pMacrocells[IDk][1]) <= 0.0f)
+		return;
+
+	atomicMin(&pBounds[0], IDx);
+	atomicMin(&pBounds[1], IDy);
+	atomicMin(&pBounds[2], IDz);
+	atomicMax(&pBounds[3], IDx + 1);
+	atomicMax(&pBounds[4], IDy + 1);
+	atomicMax(&pBounds[5], IDz + 1);
+}
+
+void UpdateMacrocells(Volume& Volume, const ExposureRender::Volume* pDeviceVolume, const Vec3i& Offset, const Vec3i& Extent)
+{
+	if (Volume.Macrocells.GetNoElements() <= 0)
+		return;
+
+	LAUNCH_DIMENSIONS(Extent[0], Extent[1], Extent[2], 8, 8, 4)
+	LAUNCH_CUDA_KERNEL((KrnlComputeMacrocells<<<GridDim, BlockDim>>>(pDeviceVolume, Volume.Macrocells.Data, Volume.Macrocells.Resolution, Offset, Extent)));
+}
+
+void ComputeMacrocells(Volume& Volume, const ExposureRender::Volume* pDeviceVolume)
+{
+	const Vec3i Resolution = Volume.Resolution;
+
+	if (Resolution[0] * Resolution[1] * Resolution[2] <= 0)
+		return;
+
+	const Vec3i MacrocellResolution((Resolution[0] + MACROCELL_SIZE - 1) / MACROCELL_SIZE, (Resolution[1] + MACROCELL_SIZE - 1) / MACROCELL_SIZE, (Resolution[2] + MACROCELL_SIZE - 1) / MACROCELL_SIZE);
+
+	Volume.Macrocells.Resize(MacrocellResolution);
+
+	UpdateMacrocells(Volume, pDeviceVolume, Vec3i(0), MacrocellResolution);
+}
+
+/*
+	Shrinks the bounding box the tracer marches through to the macrocells that are visible under
+	its opacity transfer function, padded by one voxel for interpolation and gradient lookups
+*/
+void ComputeVisibleBoundingBox(Tracer& Tracer, const Volume& Volume)
+{
+	const Vec3i MacrocellResolution = Volume.Macrocells.Resolution;
+
+	if (Volume.Macrocells.GetNoElements() <= 0)
+	{
+		Tracer.VisibleBoundingBox = Volume.BoundingBox;
+		return;
+	}
+
+	int Bounds[6] = { MacrocellResolution[0], MacrocellResolution[1], MacrocellResolution[2], 0, 0, 0 };
+
+	int* pBounds = NULL;
+
+	Cuda::Allocate(pBounds, 6);
+	Cuda::MemCopyHostToDevice(Bounds, pBounds, 6);
+
+	// The 2D transfer functions are too large to pass by value, so the kernel reads a temporary device copy of the tracer
+	ExposureRender::Tracer* pDeviceTracer = NULL;
+
+	Cuda::Allocate(pDeviceTracer);
+	Cuda::MemCopyHostToDevice(&Tracer, pDeviceTracer);
+
+	LAUNCH_DIMENSIONS(MacrocellResolution[0], MacrocellResolution[1], MacrocellResolution[2], 8, 8, 4)
+	LAUNCH_CUDA_KERNEL((KrnlComputeVisibleBounds<<<GridDim, BlockDim>>>(Volume.Macrocells.Data, MacrocellResolution, pDeviceTracer, pBounds)));
+
+	Cuda::MemCopyDeviceToHost(pBounds, Bounds, 6);
+	Cuda::Free(pBounds);
+	Cuda::Free(pDeviceTracer);
+
+	if (Bounds[0] >= Bounds[3])
+	{
+		Tracer.VisibleBoundingBox = BoundingBox();
+		return;
+	}
+
+	const Vec3i Resolution = Volume.Resolution;
+
+	Vec3f MinP, MaxP;
+
+	for (int i = 0; i < 3; i++)
+	{
+		MinP[i] = Volume.BoundingBox.MinP[i] + (float)max(Bounds[i] * MACROCELL_SIZE - 1, 0) * Volume.Spacing[i];
+		MaxP[i] = Volume.BoundingBox.MinP[i] + (float)min(Bounds[i + 3] * MACROCELL_SIZE + 1, Resolution[i]) * Volume.Spacing[i];
+	}
+
+	Tracer.VisibleBoundingBox = BoundingBox(MinP, MaxP);
+}
+
+}
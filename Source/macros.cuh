@@ -72,6 +72,16 @@ namespace Cuda
 	Cuda::HandleCudaError(cudaThreadSynchronize());															\
 }
 
+/*
+	Launches on a stream without synchronizing, the caller synchronizes the stream once its work is issued
+*/
+#define LAUNCH_CUDA_KERNEL_ASYNC(cudakernelcall)															\
+{																											\
+	cudakernelcall;																							\
+																											\
+	Cuda::HandleCudaError(cudaGetLastError());																\
+}
+
 #define KERNEL_1D(width)																					\
 	const int IDx 	= blockIdx.x * blockDim.x + threadIdx.x;												\
 	const int IDt	= threadIdx.x;																			\
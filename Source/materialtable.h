@@ -0,0 +1,162 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "buffer3d.h"
+#include "transferfunction.h"
+#include "utilities.h"
+
+namespace ExposureRender
+{
+
+/*
+	All material parameters of a single intensity, padded to 64 bytes so that a scatter event reads
+	exactly one cache line
+*/
+class EXPOSURE_RENDER_DLL ALIGN(64) Material
+{
+public:
+	HOST_DEVICE Material() :
+		Diffuse(),
+		Specular(),
+		Emission(),
+		Exponent(0.0f),
+		Opacity(0.0f)
+	{
+	}
+
+	ColorXYZf	Diffuse;
+	ColorXYZf	Specular;
+	ColorXYZf	Emission;
+	float		Exponent;
+	float		Opacity;
+};
+
+/*
+	Interleaved table of materials, sampled at MATERIAL_NO_SAMPLES intensities over the union of the
+	node ranges of the 1D transfer functions. Outside that union all functions are constant, so
+	clamping the lookup intensity is exact
+*/
+class EXPOSURE_RENDER_DLL MaterialTable
+{
+public:
+	HOST MaterialTable() :
+		Range(),
+		Materials(Enums::Device, "Device Materials"),
+		Specular(false),
+		Emissive(false)
+	{
+	}
+
+	HOST virtual ~MaterialTable(void)
+	{
+	}
+
+	HOST MaterialTable(const MaterialTable& Other) :
+		Range(),
+		Materials(Enums::Device, "Device Materials"),
+		Specular(false),
+		Emissive(false)
+	{
+		*this = Other;
+	}
+
+	HOST MaterialTable& MaterialTable::operator = (const MaterialTable& Other)
+	{
+		this->Range		= Other.Range;
+		this->Materials	= Other.Materials;
+		this->Specular	= Other.Specular;
+		this->Emissive	= Other.Emissive;
+
+		return *this;
+	}
+
+	/*
+		Records whether any visible material is specular or emissive, every intensity counts as visible
+		when AllVisible is set
+	*/
+	HOST void Bake(const ScalarTransferFunction1D& Opacity1D, const ColorTransferFunction1D& Diffuse1D, const ColorTransferFunction1D& Specular1D, const ScalarTransferFunction1D& Glossiness1D, const ColorTransferFunction1D& Emission1D, const bool& AllVisible = false)
+	{
+		const ExposureRender::Range Ranges[11] =
+		{
+			Opacity1D.PLF.GetNodeRange(),
+			Diffuse1D.PLF[0].GetNodeRange(), Diffuse1D.PLF[1].GetNodeRange(), Diffuse1D.PLF[2].GetNodeRange(),
+			Specular1D.PLF[0].GetNodeRange(), Specular1D.PLF[1].GetNodeRange(), Specular1D.PLF[2].GetNodeRange(),
+			Glossiness1D.PLF.GetNodeRange(),
+			Emission1D.PLF[0].GetNodeRange(), Emission1D.PLF[1].GetNodeRange(), Emission1D.PLF[2].GetNodeRange()
+		};
+
+		float Min = FLT_MAX, Max = -FLT_MAX;
+
+		for (int i = 0; i < 11; i++)
+		{
+			// Functions without nodes have an inverted range
+			if (Ranges[i].Min > Ranges[i].Max)
+				continue;
+
+			Min = min(Min, Ranges[i].Min);
+			Max = max(Max, Ranges[i].Max);
+		}
+
+		if (Min > Max)
+			Min = Max = 0.0f;
+
+		this->Range.Set(Min, Max);
+
+		Buffer3D<Material> HostMaterials(Enums::Host, "Host Materials");
+
+		HostMaterials.Resize(Vec3i(MATERIAL_NO_SAMPLES, 1, 1));
+
+		this->Specular = false;
+		this->Emissive = false;
+
+		for (int i = 0; i < MATERIAL_NO_SAMPLES; i++)
+		{
+			const float Intensity = this->Range.Min + ((float)i / (float)(MATERIAL_NO_SAMPLES - 1)) * this->Range.Extent;
+
+			Material& Material = HostMaterials[i];
+
+			Material.Diffuse	= Diffuse1D.Evaluate(Intensity);
+			Material.Specular	= Specular1D.Evaluate(Intensity);
+			Material.Emission	= Emission1D.Evaluate(Intensity);
+			Material.Exponent	= GlossinessExponent(Glossiness1D.Evaluate(Intensity));
+			Material.Opacity	= Opacity1D.Evaluate(Intensity);
+
+			if (AllVisible || Material.Opacity > 0.0f)
+			{
+				this->Specular = this->Specular || !Material.Specular.IsBlack();
+				this->Emissive = this->Emissive || !Material.Emission.IsBlack();
+			}
+		}
+
+		this->Materials.Set(Enums::Host, HostMaterials.Resolution, HostMaterials.Data);
+	}
+
+	HOST_DEVICE const Material& operator()(const float& Intensity) const
+	{
+		return this->Materials.Data[(int)(this->Range.Normalize(Intensity) * (float)(MATERIAL_NO_SAMPLES - 1) + 0.5f)];
+	}
+
+	ExposureRender::Range	Range;
+	Buffer3D<Material>		Materials;
+	bool					Specular;
+	bool					Emissive;
+};
+
+}
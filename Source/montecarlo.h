@@ -20,6 +20,7 @@
 
 #include "geometry.h"
 #include "rng.h"
+#include "fastmath.h"
 
 namespace ExposureRender
 {
@@ -83,7 +84,7 @@ HOST_DEVICE_NI Vec3f SampleHemisphere(Vec2f U, float Radius, Vec3f* pN = NULL)
 	return Vec3f(x, y, z);
 }
 
-HOST_DEVICE_NI Vec2f ConcentricSampleDisk(const Vec2f& U)
+HOST_DEVICE_NI Vec2f ConcentricSampleDisk(const Vec2f& U, const int& Accuracy = Enums::ExactMath)
 {
 	float r, theta;
 	// Map uniform random numbers to $[-1,1]^2$
@@ -133,7 +134,7 @@ HOST_DEVICE_NI Vec2f ConcentricSampleDisk(const Vec2f& U)
 	
 	theta *= PI_F / 4.f;
 
-	return Vec2f(r*cosf(theta), r*sinf(theta));
+	return Vec2f(r * Cos(theta, Accuracy), r * Sin(theta, Accuracy));
 }
 
 HOST_DEVICE_NI Vec3f CosineWeightedHemisphere(const Vec2f& U)
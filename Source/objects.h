@@ -25,7 +25,9 @@ namespace ExposureRender
 
 HOST_DEVICE_NI void IntersectObject(const Object& Object, const Ray& R, ScatterEvent& RS)
 {
-	Ray Rt = TransformRay(Object.Shape.InvTM, R);
+	float Scale = 1.0f;
+
+	const Ray Rt = TransformRay(Object.Shape.InvTM, R, Scale);
 
 	Intersection Int;
 
@@ -36,7 +38,7 @@ HOST_DEVICE_NI void IntersectObject(const Object& Object, const Ray& R, ScatterE
 		RS.Valid	= true;
 		RS.N 		= TransformVector(Object.Shape.TM, Int.N);
 		RS.P 		= TransformPoint(Object.Shape.TM, Int.P);
-		RS.T 		= Length(RS.P - R.O);
+		RS.T 		= Int.NearT / Scale;
 		RS.Wo		= -R.D;
 		RS.Le		= ColorXYZf(0.0f);
 		RS.UV		= Int.UV;
@@ -28,7 +28,7 @@ class EXPOSURE_RENDER_DLL PiecewiseConstantFunction : PiecewiseFunction<Size>
 {
 public:
 	HOST PiecewiseConstantFunction() :
-		PiecewiseFunction(),
+		PiecewiseFunction<Size>()
 	{
 	}
 
@@ -43,14 +43,14 @@ public:
 
 	HOST PiecewiseConstantFunction& operator = (const PiecewiseConstantFunction& Other)
 	{
-		PiecewiseFunction::operator = (Other);
+		PiecewiseFunction<Size>::operator = (Other);
 
 		return *this;
 	}
 
 	HOST void AddNode(const float& Position, const float& Value)
 	{
-		if (this->Count + 1 >= MAX_NO_TF_NODES)
+		if (this->Count + 1 >= Size)
 			return;
 
 		this->Position[this->Count] = Position;
@@ -68,18 +68,19 @@ public:
 	HOST void SortNodes()
 	{
 		NodesVector<Size> PositionTemp, ValueTemp;
-		
-		float Max = FLT_MAX;
-		
-		int ID = -1;
 
+		// Selection sort, each pass moves the node with the smallest remaining position to the output
 		for (int i = 0; i < this->Count; i++)
 		{
-			for (int j = 0; j < this->Count; i++)
+			float Min = FLT_MAX;
+		
+			int ID = 0;
+
+			for (int j = 0; j < this->Count; j++)
 			{
-				if (this->Position[j] <= Max)
+				if (this->Position[j] <= Min)
 				{
-					Max = this->Position[j];
+					Min = this->Position[j];
 					ID = j;
 				}
 			}
@@ -99,11 +100,24 @@ public:
 		if (this->Count <= 2)
 			return;
 
+		// Removes interior nodes that have the same value as both neighbours, they do not change the function
+		int NewCount = 1;
+
 		for (int i = 1; i < this->Count - 1; i++)
 		{
-			if (this->Value[i] == this->Value[i - 1] && this->Value[i] == this->Value[i + 1])
-			
+			if (this->Value[i] == this->Value[NewCount - 1] && this->Value[i] == this->Value[i + 1])
+				continue;
+
+			this->Position[NewCount]	= this->Position[i];
+			this->Value[NewCount]		= this->Value[i];
+
+			NewCount++;
 		}
+
+		this->Position[NewCount]	= this->Position[this->Count - 1];
+		this->Value[NewCount]		= this->Value[this->Count - 1];
+
+		this->Count = NewCount + 1;
 	}
 
 	HOST_DEVICE float Evaluate(const float& Position) const
@@ -119,16 +133,11 @@ public:
 
 		for (int i = 1; i < this->Count; i++)
 		{
-			float P1 = this->Position[i - 1];
-			float P2 = this->Position[i];
-			float DeltaP = P2 - P1;
-			float LerpT = (Position - P1) / DeltaP;
-
-			if (Position >= P1 && Position < P2)
-				return this->Value[i - 1] + LerpT * (this->Value[i] - this->Value[i - 1]);
+			if (Position >= this->Position[i - 1] && Position < this->Position[i])
+				return this->Value[i - 1];
 		}
 
-		return 0.0f;
+		return this->Value[this->Count - 1];
 	}
 };
 
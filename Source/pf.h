@@ -64,6 +64,20 @@ public:
 		return *this;
 	}
 
+	HOST bool operator == (const PiecewiseFunction& Other) const
+	{
+		if (this->Count != Other.Count)
+			return false;
+
+		for (int i = 0; i < this->Count; i++)
+		{
+			if (this->Position[i] != Other.Position[i] || this->Value[i] != Other.Value[i])
+				return false;
+		}
+
+		return true;
+	}
+
 	Vec2f				NodeRange;
 	NodesVector<Size>	Position;
 	NodesVector<Size>	Value;
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "pf.h"
+#include "range.h"
 
 namespace ExposureRender
 {
@@ -48,6 +49,11 @@ public:
 		return *this;
 	}
 
+	HOST bool operator == (const PiecewiseLinearFunction& Other) const
+	{
+		return PiecewiseFunction<Size>::operator == (Other);
+	}
+
 	HOST void AddNode(const float& Position, const float& Value)
 	{
 		if (this->Count + 1 >= MAX_NO_TF_NODES)
@@ -73,7 +79,7 @@ public:
 		if (Position < this->NodeRange[0])
 			return this->Value[0];
 
-		if (Position > this->NodeRange[1])
+		if (Position >= this->NodeRange[1])
 			return this->Value[this->Count - 1];
 
 		for (int i = 1; i < this->Count; i++)
@@ -89,6 +95,28 @@ public:
 
 		return 0.0f;
 	}
+
+	HOST_DEVICE Range GetNodeRange() const
+	{
+		return Range(this->NodeRange[0], this->NodeRange[1]);
+	}
+
+	/*
+		Maximum of the function over [Min, Max], a linear segment peaks at one of its end points so
+		only the interval bounds and the nodes inside the interval need to be considered
+	*/
+	HOST_DEVICE float Maximum(const float& Min, const float& Max) const
+	{
+		float Result = fmaxf(this->Evaluate(Min), this->Evaluate(Max));
+
+		for (int i = 0; i < this->Count; i++)
+		{
+			if (this->Position[i] > Min && this->Position[i] < Max)
+				Result = fmaxf(Result, this->Value[i]);
+		}
+
+		return Result;
+	}
 };
 
 }
@@ -0,0 +1,62 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "macros.cuh"
+#include "volume.h"
+#include "tracer.h"
+
+namespace ExposureRender
+{
+
+/*
+	Entry (x, y) holds the mean opacity of a ray segment whose intensity varies linearly from front
+	sample x to back sample y, so thin features between two samples are no longer stepped over. The baked
+	opacity function is read through gpTracer
+*/
+KERNEL void KrnlComputePreIntegration(Range IntensityRange, float* pTable)
+{
+	KERNEL_2D(PREINTEGRATION_NO_SAMPLES, PREINTEGRATION_NO_SAMPLES)
+
+	const float DeltaX = IntensityRange.Extent / (float)(PREINTEGRATION_NO_SAMPLES - 1);
+
+	const float Front	= IntensityRange.Min + (float)IDx * DeltaX;
+	const float Back	= IntensityRange.Min + (float)IDy * DeltaX;
+
+	const TransferFunctionTable& Opacity = gpTracer->OpacityTable;
+
+	if (IDx == IDy)
+		pTable[IDk] = Opacity.Lookup(Front);
+	else
+		pTable[IDk] = Opacity.Integrate(Front, Back) / fabsf(Back - Front);
+}
+
+void ComputePreIntegration(Tracer& Tracer, const Volume& Volume)
+{
+	Tracer.PreIntegrationRange = Volume.IntensityRange;
+
+	Tracer.PreIntegratedOpacity.Resize(Vec2i(PREINTEGRATION_NO_SAMPLES, PREINTEGRATION_NO_SAMPLES));
+
+	gTracers.Synchronize(Tracer.ID);
+
+	LAUNCH_DIMENSIONS(PREINTEGRATION_NO_SAMPLES, PREINTEGRATION_NO_SAMPLES, 1, 16, 16, 1)
+	LAUNCH_CUDA_KERNEL((KrnlComputePreIntegration<<<GridDim, BlockDim>>>(Volume.IntensityRange, Tracer.PreIntegratedOpacity.Data)));
+}
+
+}
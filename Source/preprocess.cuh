@@ -0,0 +1,213 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "macros.cuh"
+#include "statistics.cuh"
+#include "gradientmagnitude.cuh"
+#include "gradients.cuh"
+#include "macrocells.cuh"
+
+namespace ExposureRender
+{
+
+/*
+	Computes all data derived from the voxels of a volume, called whenever the voxels of a volume change.
+	The kernels read the voxels through a temporary device copy of the volume, so that dense and sparse
+	volumes are handled alike
+*/
+void PreprocessVolume(Volume& Volume)
+{
+	DebugLog(__FUNCTION__);
+
+	ExposureRender::Volume* pDeviceVolume = NULL;
+
+	Cuda::Allocate(pDeviceVolume);
+	Cuda::MemCopyHostToDevice(&Volume, pDeviceVolume);
+
+	ComputeStatistics(Volume, pDeviceVolume);
+	ComputeGradientMagnitudeVolume(Volume, pDeviceVolume);
+	ComputeGradientVolume(Volume, pDeviceVolume);
+	ComputeMacrocells(Volume, pDeviceVolume);
+
+	Cuda::Free(pDeviceVolume);
+}
+
+/*
+	Allocates the derived data of a dense volume ahead of PreprocessVolumeAsync, device allocations
+	synchronize the whole device and can therefore not be made while it runs
+*/
+void AllocateDerivedVolumes(Volume& Volume)
+{
+	const Vec3i Resolution = Volume.Resolution;
+
+	Volume.GradientMagnitudes.Resize(Resolution);
+
+	if (Volume.CacheGradients)
+		Volume.Gradients.Resize(Resolution);
+	else
+		Volume.Gradients.Free();
+
+	Volume.Macrocells.Resize(Vec3i((Resolution[0] + MACROCELL_SIZE - 1) / MACROCELL_SIZE, (Resolution[1] + MACROCELL_SIZE - 1) / MACROCELL_SIZE, (Resolution[2] + MACROCELL_SIZE - 1) / MACROCELL_SIZE));
+}
+
+/*
+	Same as PreprocessVolume for a dense volume, but issues all work on Stream without allocating or
+	synchronizing the device, so that it overlaps with rendering. pDeviceVolume is a device copy of
+	Volume, made after AllocateDerivedVolumes. pRanges holds 4 and pHistogram NO_HISTOGRAM_BINS elements
+*/
+void PreprocessVolumeAsync(Volume& Volume, const ExposureRender::Volume* pDeviceVolume, unsigned int* pRanges, int* pHistogram, cudaStream_t Stream)
+{
+	const Vec3i Resolution			= Volume.Resolution;
+	const Vec3i MacrocellResolution	= Volume.Macrocells.Resolution;
+
+	unsigned int Ranges[4] = { 0xffffffff, 0, 0xffffffff, 0 };
+
+	Cuda::MemCopyHostToDeviceAsync(Ranges, pRanges, 4, Stream);
+
+	{
+		LAUNCH_DIMENSIONS(Resolution[0], Resolution[1], Resolution[2], STATISTICS_BLOCK_SIZE, STATISTICS_BLOCK_SIZE, STATISTICS_BLOCK_SIZE)
+		LAUNCH_CUDA_KERNEL_ASYNC((KrnlComputeRanges<<<GridDim, BlockDim, 0, Stream>>>(pDeviceVolume, Vec3i(0), Resolution, pRanges)));
+	}
+
+	Cuda::MemCopyDeviceToHostAsync(pRanges, Ranges, 4, Stream);
+	Cuda::StreamSynchronize(Stream);
+
+	float GradientMagnitudes[2];
+
+	memcpy(&GradientMagnitudes[0], &Ranges[2], sizeof(float));
+	memcpy(&GradientMagnitudes[1], &Ranges[3], sizeof(float));
+
+	Volume.IntensityRange.Set((float)Ranges[0], (float)Ranges[1]);
+	Volume.GradientMagnitudeRange.Set(GradientMagnitudes[0], GradientMagnitudes[1]);
+
+	Cuda::MemSetAsync(pHistogram, 0, NO_HISTOGRAM_BINS, Stream);
+
+	{
+		LAUNCH_DIMENSIONS(min(Resolution[0] * Resolution[1] * Resolution[2], HISTOGRAM_BLOCK_SIZE * HISTOGRAM_MAX_NO_BLOCKS), 1, 1, HISTOGRAM_BLOCK_SIZE, 1, 1)
+		LAUNCH_CUDA_KERNEL_ASYNC((KrnlComputeHistogram<<<GridDim, BlockDim, 0, Stream>>>(pDeviceVolume, Vec3i(0), Resolution, Volume.IntensityRange.Min, Volume.IntensityRange.Inv, pHistogram)));
+	}
+
+	{
+		LAUNCH_DIMENSIONS(Resolution[0], Resolution[1], Resolution[2], 8, 8, 4)
+		LAUNCH_CUDA_KERNEL_ASYNC((KrnlComputeGradientMagnitudeVolume<<<GridDim, BlockDim, 0, Stream>>>(pDeviceVolume, Volume.GradientMagnitudes.Data, Resolution, Vec3i(0), Resolution, Volume.GradientMagnitudeRange)));
+
+		if (Volume.Gradients.GetNoElements() > 0)
+			LAUNCH_CUDA_KERNEL_ASYNC((KrnlComputeGradientVolume<<<GridDim, BlockDim, 0, Stream>>>(pDeviceVolume, Volume.Gradients.Data, Resolution, Vec3i(0), Resolution, Volume.GradientMagnitudeRange)));
+	}
+
+	{
+		LAUNCH_DIMENSIONS(MacrocellResolution[0], MacrocellResolution[1], MacrocellResolution[2], 8, 8, 4)
+		LAUNCH_CUDA_KERNEL_ASYNC((KrnlComputeMacrocells<<<GridDim, BlockDim, 0, Stream>>>(pDeviceVolume, Volume.Macrocells.Data, MacrocellResolution, Vec3i(0), MacrocellResolution)));
+	}
+
+	Cuda::MemCopyDeviceToHostAsync(pHistogram, Volume.Histogram, NO_HISTOGRAM_BINS, Stream);
+	Cuda::StreamSynchronize(Stream);
+
+	DebugLog("%s, intensity range = [%0.2f, %0.2f], gradient magnitude range = [%0.2f, %0.2f]", __FUNCTION__, Volume.IntensityRange.Min, Volume.IntensityRange.Max, Volume.GradientMagnitudeRange.Min, Volume.GradientMagnitudeRange.Max);
+}
+
+/*
+	Voxels whose derived data depends on the voxels in [Min, Max), the box dilated by one voxel for the
+	central differences and rounded out to whole macrocells
+*/
+void GetPreprocessRegion(const Vec3i& Resolution, const Vec3i& Min, const Vec3i& Max, Vec3i& RegionMin, Vec3i& RegionMax)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		RegionMin[i] = (max(Min[i] - 1, 0) / MACROCELL_SIZE) * MACROCELL_SIZE;
+		RegionMax[i] = min(((Max[i] + MACROCELL_SIZE) / MACROCELL_SIZE) * MACROCELL_SIZE, Resolution[i]);
+	}
+}
+
+/*
+	Replaces the voxels in [Min, Max) by pVoxels and refreshes the derived data inside the preprocess region
+	only. The ranges of the volume are widened conservatively instead of reduced again, when one widens the
+	data quantized over it is recomputed for the whole volume. Returns whether a range changed
+*/
+bool PreprocessRegion(Volume& Volume, const Vec3i& Min, const Vec3i& Max, unsigned short* pVoxels)
+{
+	DebugLog(__FUNCTION__);
+
+	Vec3i RegionMin, RegionMax;
+
+	GetPreprocessRegion(Volume.Resolution, Min, Max, RegionMin, RegionMax);
+
+	const Vec3i RegionExtent = RegionMax - RegionMin;
+
+	ExposureRender::Volume* pDeviceVolume = NULL;
+
+	Cuda::Allocate(pDeviceVolume);
+	Cuda::MemCopyHostToDevice(&Volume, pDeviceVolume);
+
+	int Previous[NO_HISTOGRAM_BINS];
+
+	ComputeHistogram(pDeviceVolume, Min, Max - Min, Volume.IntensityRange, Previous);
+
+	Volume.Voxels.SetBox(Min, Max, pVoxels);
+
+	Range IntensityRange, GradientMagnitudeRange;
+
+	ComputeRanges(pDeviceVolume, RegionMin, RegionExtent, IntensityRange, GradientMagnitudeRange);
+
+	const bool IntensityRangeChanged			= IntensityRange.Min < Volume.IntensityRange.Min || IntensityRange.Max > Volume.IntensityRange.Max;
+	const bool GradientMagnitudeRangeChanged	= GradientMagnitudeRange.Min < Volume.GradientMagnitudeRange.Min || GradientMagnitudeRange.Max > Volume.GradientMagnitudeRange.Max;
+
+	if (IntensityRangeChanged)
+	{
+		Volume.IntensityRange.Set(min(Volume.IntensityRange.Min, IntensityRange.Min), max(Volume.IntensityRange.Max, IntensityRange.Max));
+
+		ComputeHistogram(pDeviceVolume, Vec3i(0), Volume.Resolution, Volume.IntensityRange, Volume.Histogram);
+	}
+	else
+	{
+		int Current[NO_HISTOGRAM_BINS];
+
+		ComputeHistogram(pDeviceVolume, Min, Max - Min, Volume.IntensityRange, Current);
+
+		for (int i = 0; i < NO_HISTOGRAM_BINS; i++)
+			Volume.Histogram[i] += Current[i] - Previous[i];
+	}
+
+	if (GradientMagnitudeRangeChanged)
+	{
+		Volume.GradientMagnitudeRange.Set(min(Volume.GradientMagnitudeRange.Min, GradientMagnitudeRange.Min), max(Volume.GradientMagnitudeRange.Max, GradientMagnitudeRange.Max));
+
+		UpdateGradientMagnitudeVolume(Volume, pDeviceVolume, Vec3i(0), Volume.Resolution);
+		UpdateGradientVolume(Volume, pDeviceVolume, Vec3i(0), Volume.Resolution);
+	}
+	else
+	{
+		UpdateGradientMagnitudeVolume(Volume, pDeviceVolume, RegionMin, RegionExtent);
+		UpdateGradientVolume(Volume, pDeviceVolume, RegionMin, RegionExtent);
+	}
+
+	const Vec3i MacrocellMin(RegionMin[0] / MACROCELL_SIZE, RegionMin[1] / MACROCELL_SIZE, RegionMin[2] / MACROCELL_SIZE);
+	const Vec3i MacrocellMax((RegionMax[0] + MACROCELL_SIZE - 1) / MACROCELL_SIZE, (RegionMax[1] + MACROCELL_SIZE - 1) / MACROCELL_SIZE, (RegionMax[2] + MACROCELL_SIZE - 1) / MACROCELL_SIZE);
+
+	UpdateMacrocells(Volume, pDeviceVolume, MacrocellMin, MacrocellMax - MacrocellMin);
+
+	Cuda::Free(pDeviceVolume);
+
+	DebugLog("%s, region = [%d, %d, %d] - [%d, %d, %d], ranges changed = %s", __FUNCTION__, RegionMin[0], RegionMin[1], RegionMin[2], RegionMax[0], RegionMax[1], RegionMax[2], IntensityRangeChanged || GradientMagnitudeRangeChanged ? "true" : "false");
+
+	return IntensityRangeChanged || GradientMagnitudeRangeChanged;
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "vector.h"
+
+namespace ExposureRender
+{
+
+class EXPOSURE_RENDER_DLL Range
+{
+public:
+	HOST_DEVICE Range(const float& Min = 0.0f, const float& Max = 1.0f)
+	{
+		this->Set(Min, Max);
+	}
+
+	HOST_DEVICE Range& Range::operator = (const Range& Other)
+	{
+		this->Min		= Other.Min;
+		this->Max		= Other.Max;
+		this->Extent	= Other.Extent;
+		this->Inv		= Other.Inv;
+
+		return *this;
+	}
+
+	HOST_DEVICE void Set(const float& Min, const float& Max)
+	{
+		this->Min		= Min;
+		this->Max		= Max;
+		this->Extent	= Max - Min;
+		this->Inv		= this->Extent > 0.0f ? 1.0f / this->Extent : 0.0f;
+	}
+
+	HOST_DEVICE float Normalize(const float& Value) const
+	{
+		return Clamp((Value - this->Min) * this->Inv, 0.0f, 1.0f);
+	}
+
+	float	Min;
+	float	Max;
+	float	Extent;
+	float	Inv;
+};
+
+}
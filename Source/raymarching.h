@@ -27,6 +27,79 @@
 namespace ExposureRender
 {
 
+/*
+	Intensity for classification during ray marching, reconstructed from the 8-bit windowed copy of
+	the tracer when it has one. Gradients keep using the full precision voxels
+*/
+HOST_DEVICE float GetClassifiedIntensity(const Vec3f& P)
+{
+	const Buffer3D<unsigned char>& Voxels = gpTracer->ClassifiedVoxels;
+
+	if (Voxels.GetNoElements() <= 0)
+		return GetIntensity(gpTracer->VolumeID, P);
+
+	const Vec3f XYZ = gpVolumes[gpTracer->VolumeID].GetLocalCoordinate(P);
+
+	const int X = (int)floorf(XYZ[0]);
+	const int Y = (int)floorf(XYZ[1]);
+	const int Z = (int)floorf(XYZ[2]);
+
+	const float DX = XYZ[0] - X;
+	const float DY = XYZ[1] - Y;
+	const float DZ = XYZ[2] - Z;
+
+	const float C00 = Lerp(DX, (float)Voxels(X, Y, Z), (float)Voxels(X + 1, Y, Z));
+	const float C10 = Lerp(DX, (float)Voxels(X, Y + 1, Z), (float)Voxels(X + 1, Y + 1, Z));
+	const float C01 = Lerp(DX, (float)Voxels(X, Y, Z + 1), (float)Voxels(X + 1, Y, Z + 1));
+	const float C11 = Lerp(DX, (float)Voxels(X, Y + 1, Z + 1), (float)Voxels(X + 1, Y + 1, Z + 1));
+	const float C0	= Lerp(DY, C00, C10);
+	const float C1	= Lerp(DY, C01, C11);
+
+	return gpTracer->ClassificationWindow.Min + Lerp(DZ, C0, C1) * gpTracer->ClassificationWindow.Extent * ONE_OVER_255;
+}
+
+/*
+	Mean opacity of the ray segment between two consecutive samples, looked up in the tracer's
+	pre-integration table, falls back to the opacity at the segment midpoint when there is no table
+*/
+HOST_DEVICE float GetPreIntegratedOpacity(const float& Front, const float& Back)
+{
+	if (gpTracer->PreIntegratedOpacity.GetNoElements() <= 0)
+		return gpTracer->OpacityTable.Lookup(0.5f * (Front + Back));
+
+	const float Scale = (float)(PREINTEGRATION_NO_SAMPLES - 1);
+
+	return gpTracer->PreIntegratedOpacity(Vec2f(gpTracer->PreIntegrationRange.Normalize(Front) * Scale, gpTracer->PreIntegrationRange.Normalize(Back) * Scale));
+}
+
+/*
+	Opacity scale of the label at P, one when the tracer has no label volume
+*/
+HOST_DEVICE float GetLabelOpacity(const Vec3f& P)
+{
+	if (gpTracer->LabelVolumeID < 0)
+		return 1.0f;
+
+	return gpTracer->GetLabelOpacity(GetLabelID(gpTracer->LabelVolumeID, P));
+}
+
+/*
+	Extinction coefficient of the segment between two consecutive samples, 2D transfer functions
+	classify the back sample with its cached gradient magnitude. Labels are looked up at the back sample
+*/
+HOST_DEVICE float GetSegmentSigmaT(const float& Front, const float& Back, const Vec3f& P)
+{
+	const float LabelOpacity = GetLabelOpacity(P);
+
+	if (LabelOpacity <= 0.0f)
+		return 0.0f;
+
+	if (gpTracer->Opacity2D.Enabled())
+		return LabelOpacity * gpTracer->RenderSettings.Shading.DensityScale * gpTracer->Opacity2D.Evaluate(Back, GetGradientMagnitude(gpTracer->VolumeID, P));
+
+	return LabelOpacity * gpTracer->RenderSettings.Shading.DensityScale * GetPreIntegratedOpacity(Front, Back);
+}
+
 HOST_DEVICE_NI void SampleVolume(Ray R, CRNG& RNG, ScatterEvent& SE)
 {
 	float MinT;
@@ -34,7 +107,7 @@ HOST_DEVICE_NI void SampleVolume(Ray R, CRNG& RNG, ScatterEvent& SE)
 	
 	Intersection Int;
 
-	IntersectBox(R, gpVolumes[gpTracer->VolumeID].BoundingBox.MinP, gpVolumes[gpTracer->VolumeID].BoundingBox.MaxP, Int);
+	IntersectBox(R, gpTracer->VisibleBoundingBox.MinP, gpTracer->VisibleBoundingBox.MaxP, Int);
 
 	if (!Int.Valid)
 		return;
@@ -42,7 +115,7 @@ HOST_DEVICE_NI void SampleVolume(Ray R, CRNG& RNG, ScatterEvent& SE)
 	MinT = max(Int.NearT, R.MinT);
 	MaxT = min(Int.FarT, R.MaxT);
 
-	const float S	= -log(RNG.Get1()) / gpTracer->RenderSettings.Shading.DensityScale;
+	const float S	= -Log(RNG.Get1(), gpTracer->RenderSettings.Shading.MathAccuracy) / gpTracer->RenderSettings.Shading.DensityScale;
 	float Sum		= 0.0f;
 	float SigmaT	= 0.0f;
 
@@ -50,23 +123,39 @@ HOST_DEVICE_NI void SampleVolume(Ray R, CRNG& RNG, ScatterEvent& SE)
 
 	const float StepSize = gpTracer->RenderSettings.Traversal.StepFactorPrimary * gpVolumes[gpTracer->VolumeID].MinStep;
 
+	const bool SkipEmpty = gpVolumes[gpTracer->VolumeID].SparseGrid.Enabled && gpTracer->GetOpacity(gpVolumes[gpTracer->VolumeID].SparseGrid.Background, 0.0f) <= 0.0f;
+
 	MinT += RNG.Get1() * StepSize;
 
+	float Front = GetClassifiedIntensity(R.O + MinT * R.D);
+
 	while (Sum < S)
 	{
-		Ps = R.O + MinT * R.D;
-
 		if (MinT >= MaxT)
 			return;
 		
-		float Intensity = GetIntensity(gpTracer->VolumeID, Ps);
+		if (SkipEmpty && SkipEmptySpace(gpTracer->VolumeID, R, MinT))
+		{
+			Front = GetClassifiedIntensity(R.O + MinT * R.D);
+			continue;
+		}
 
-		SigmaT	= gpTracer->RenderSettings.Shading.DensityScale * gpTracer->Opacity1D.Evaluate(Intensity);
+		const Vec3f Pb		= R.O + (MinT + StepSize) * R.D;
+		const float Back	= GetClassifiedIntensity(Pb);
+
+		SigmaT	= GetSegmentSigmaT(Front, Back, Pb);
 
 		Sum		+= SigmaT * StepSize;
 		MinT	+= StepSize;
+		Front	= Back;
 	}
 
+	// Back up to where the accumulated optical depth crossed the threshold inside the last segment
+	if (SigmaT > 0.0f)
+		MinT -= (Sum - S) / SigmaT;
+
+	Ps = R.O + MinT * R.D;
+
 	SE.SetValid(MinT, Ps, NormalizedGradient(gpTracer->VolumeID, Ps), -R.D, ColorXYZf());
 }
 
@@ -74,11 +163,10 @@ HOST_DEVICE_NI bool ScatterEventInVolume(Ray R, CRNG& RNG)
 {
 	float MinT;
 	float MaxT;
-	Vec3f Ps;
 
 	Intersection Int;
 		
-	IntersectBox(R, gpVolumes[gpTracer->VolumeID].BoundingBox.MinP, gpVolumes[gpTracer->VolumeID].BoundingBox.MaxP, Int);
+	IntersectBox(R, gpTracer->VisibleBoundingBox.MinP, gpTracer->VisibleBoundingBox.MaxP, Int);
 	
 	if (!Int.Valid)
 		return false;
@@ -86,32 +174,86 @@ HOST_DEVICE_NI bool ScatterEventInVolume(Ray R, CRNG& RNG)
 	MinT = max(Int.NearT, R.MinT);
 	MaxT = min(Int.FarT, R.MaxT);
 
-	const float S	= -log(RNG.Get1()) / gpTracer->RenderSettings.Shading.DensityScale;
+	const float S	= -Log(RNG.Get1(), gpTracer->RenderSettings.Shading.MathAccuracy) / gpTracer->RenderSettings.Shading.DensityScale;
 	float Sum		= 0.0f;
 	float SigmaT	= 0.0f;
 
 	const float StepSize = gpTracer->RenderSettings.Traversal.StepFactorShadow * gpVolumes[gpTracer->VolumeID].MinStep;
 
+	const bool SkipEmpty = gpVolumes[gpTracer->VolumeID].SparseGrid.Enabled && gpTracer->GetOpacity(gpVolumes[gpTracer->VolumeID].SparseGrid.Background, 0.0f) <= 0.0f;
+
 	MinT += RNG.Get1() * StepSize;
 
+	float Front = GetClassifiedIntensity(R.O + MinT * R.D);
+
 	while (Sum < S)
 	{
-		Ps = R.O + MinT * R.D;
-
 		if (MinT > MaxT)
 			return false;
 		
-		float Intensity = GetIntensity(gpTracer->VolumeID, Ps);
+		if (SkipEmpty && SkipEmptySpace(gpTracer->VolumeID, R, MinT))
+		{
+			Front = GetClassifiedIntensity(R.O + MinT * R.D);
+			continue;
+		}
+
+		const Vec3f Pb		= R.O + (MinT + StepSize) * R.D;
+		const float Back	= GetClassifiedIntensity(Pb);
 
-		SigmaT	= gpTracer->RenderSettings.Shading.DensityScale * gpTracer->Opacity1D.Evaluate(Intensity);
+		SigmaT	= GetSegmentSigmaT(Front, Back, Pb);
 
 		Sum		+= SigmaT * StepSize;
 		MinT	+= StepSize;
+		Front	= Back;
 	}
 
 	return true;
 }
 
+/*
+	Expected transmittance along R, marched at the shadow step size. The attenuation matches the
+	probability that ScatterEventInVolume finds no scatter event on the same ray
+*/
+HOST_DEVICE_NI float VolumeTransmittance(Ray R)
+{
+	Intersection Int;
+
+	IntersectBox(R, gpTracer->VisibleBoundingBox.MinP, gpTracer->VisibleBoundingBox.MaxP, Int);
+
+	if (!Int.Valid)
+		return 1.0f;
+
+	float MinT = max(Int.NearT, R.MinT);
+	float MaxT = min(Int.FarT, R.MaxT);
+
+	float Sum = 0.0f;
+
+	const float StepSize = gpTracer->RenderSettings.Traversal.StepFactorShadow * gpVolumes[gpTracer->VolumeID].MinStep;
+
+	const bool SkipEmpty = gpVolumes[gpTracer->VolumeID].SparseGrid.Enabled && gpTracer->GetOpacity(gpVolumes[gpTracer->VolumeID].SparseGrid.Background, 0.0f) <= 0.0f;
+
+	float Front = GetClassifiedIntensity(R.O + MinT * R.D);
+
+	while (MinT < MaxT)
+	{
+		if (SkipEmpty && SkipEmptySpace(gpTracer->VolumeID, R, MinT))
+		{
+			Front = GetClassifiedIntensity(R.O + MinT * R.D);
+			continue;
+		}
+
+		const float Step	= min(StepSize, MaxT - MinT);
+		const Vec3f Pb		= R.O + (MinT + Step) * R.D;
+		const float Back	= GetClassifiedIntensity(Pb);
+
+		Sum		+= GetSegmentSigmaT(Front, Back, Pb) * Step;
+		MinT	+= Step;
+		Front	= Back;
+	}
+
+	return Exp(-gpTracer->RenderSettings.Shading.DensityScale * Sum, gpTracer->RenderSettings.Shading.MathAccuracy);
+}
+
 /*
 struct Photon{
   Vec3f origin;
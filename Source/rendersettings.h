@@ -32,10 +32,13 @@ public:
 	public:
 		HOST TraversalSettings()
 		{
-			this->StepFactorPrimary	= 0.1f;
-			this->StepFactorShadow	= 0.1f;
-			this->Shadows			= true;
-			this->MaxShadowDistance	= 1.0f;
+			this->StepFactorPrimary			= 0.1f;
+			this->StepFactorShadow			= 0.1f;
+			this->Shadows					= true;
+			this->MaxShadowDistance			= 1.0f;
+			this->WindowedClassification	= false;
+			this->Wavefront					= false;
+			this->CacheTransmittance		= false;
 		}
 
 		HOST ~TraversalSettings()
@@ -49,10 +52,13 @@ public:
 
 		HOST TraversalSettings& operator = (const TraversalSettings& Other)
 		{
-			this->StepFactorPrimary		= Other.StepFactorPrimary;
-			this->StepFactorShadow		= Other.StepFactorShadow;
-			this->Shadows				= Other.Shadows;
-			this->MaxShadowDistance		= Other.MaxShadowDistance;
+			this->StepFactorPrimary			= Other.StepFactorPrimary;
+			this->StepFactorShadow			= Other.StepFactorShadow;
+			this->Shadows					= Other.Shadows;
+			this->MaxShadowDistance			= Other.MaxShadowDistance;
+			this->WindowedClassification	= Other.WindowedClassification;
+			this->Wavefront					= Other.Wavefront;
+			this->CacheTransmittance		= Other.CacheTransmittance;
 
 			return *this;
 		}
@@ -61,6 +67,9 @@ public:
 		float	StepFactorShadow;
 		bool	Shadows;
 		float	MaxShadowDistance;
+		bool	WindowedClassification;
+		bool	Wavefront;
+		bool	CacheTransmittance;
 	};
 
 	class EXPOSURE_RENDER_DLL ShadingSettings
@@ -74,6 +83,7 @@ public:
 			this->GradientComputation	= 1;
 			this->GradientThreshold		= 0.5f;
 			this->GradientFactor		= 0.5f;
+			this->MathAccuracy			= Enums::ExactMath;
 		}
 
 		HOST ~ShadingSettings()
@@ -93,6 +103,7 @@ public:
 			this->GradientComputation	= Other.GradientComputation;
 			this->GradientThreshold		= Other.GradientThreshold;
 			this->GradientFactor		= Other.GradientFactor;
+			this->MathAccuracy			= Other.MathAccuracy;
 
 			return *this;
 		}
@@ -103,6 +114,7 @@ public:
 		int		GradientComputation;
 		float	GradientThreshold;
 		float	GradientFactor;
+		int		MathAccuracy;
 	};
 
 	HOST RenderSettings()
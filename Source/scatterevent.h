@@ -151,62 +151,3 @@ public:
 };
 
 }
-
-/*
-bool BRDF = false;
-
-float PdfBrdf = 1.0f;
-
-switch (gpTracer->RenderSettings.Shading.Type)
-{
-	case 0:
-	{
-		BRDF = true;
-		break;
-	}
-
-	case 1:
-	{
-		BRDF = false;
-		break;
-	}
-
-	
-	case 2:
-	{
-		const float NGM			= GradientMagnitude(SE.P) * gpTracer->Volume.GradientMagnitudeRange.Inv;
-		const float Sensitivity	= 25;
-		const float ExpGF		= 3;
-		const float Exponent	= Sensitivity * powf(gpTracer->RenderSettings.Shading.GradientFactor, ExpGF) * NGM;
-		
-		PdfBrdf = gpTracer->RenderSettings.Shading.OpacityModulated ? GetOpacity(SE.P) * (1.0f - __expf(-Exponent)) : 1.0f - __expf(-Exponent);
-		BRDF = RNG.Get1() <= PdfBrdf;
-		break;
-	}
-
-	case 3:
-	{
-		const float NGM = GradientMagnitude(SE.P) * gpTracer->Volume.GradientMagnitudeRange.Inv;
-		
-		PdfBrdf = 1.0f - powf(1.0f - NGM, 2.0f);
-		BRDF = RNG.Get1() < PdfBrdf;
-		break;
-	}
-
-	case 4:
-	{
-		const float NGM = GradientMagnitude(SE.P) * gpTracer->Volume.GradientMagnitudeRange.Inv;
-
-		if (NGM > gpTracer->RenderSettings.Shading.GradientThreshold)
-			BRDF = true;
-		else
-			BRDF = false;
-	}
-	
-}
-
-if (BRDF)
-	return Shader(Shader::Brdf, SE.N, SE.Wo, GetDiffuse(I), GetSpecular(I), gpTracer->RenderSettings.Shading.IndexOfReflection, GetGlossiness(I));
-else
-	return Shader(Shader::Phase, SE.N, SE.Wo, GetDiffuse(I), GetSpecular(I), gpTracer->RenderSettings.Shading.IndexOfReflection, GetGlossiness(I));
-*/
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include "montecarlo.h"
 #include "sample.h"
 #include "textures.h"
+#include "fastmath.h"
 
 namespace ExposureRender
 {
@@ -134,15 +135,16 @@ public:
 	{
 	}
 
-	HOST_DEVICE Blinn(const float& Exponent) :
-		Exponent(Exponent)
+	HOST_DEVICE Blinn(const float& Exponent, const int& Accuracy = Enums::ExactMath) :
+		Exponent(Exponent),
+		Accuracy(Accuracy)
 	{
 	}
 
 	HOST_DEVICE void SampleF(const Vec3f& Wo, Vec3f& Wi, float& Pdf, const Vec2f& U)
 	{
 		// Compute sampled half-angle vector $\wh$ for Blinn distribution
-		float costheta = powf(U[0], 1.f / (this->Exponent+1));
+		float costheta = Pow(U[0], 1.f / (this->Exponent+1), this->Accuracy);
 		float sintheta = sqrtf(max(0.f, 1.f - costheta*costheta));
 		float phi = U[1] * 2.f * PI_F;
 
@@ -155,7 +157,7 @@ public:
 		Wi = -Wo + 2.f * Dot(Wo, wh) * wh;
 
 		// Compute PDF for $\wi$ from Blinn distribution
-		float blinn_pdf = ((Exponent + 1.f) * powf(costheta, this->Exponent)) / (2.f * PI_F * 4.f * Dot(Wo, wh));
+		float blinn_pdf = ((Exponent + 1.f) * Pow(costheta, this->Exponent, this->Accuracy)) / (2.f * PI_F * 4.f * Dot(Wo, wh));
 
 		if (Dot(Wo, wh) <= 0.f)
 			blinn_pdf = 0.f;
@@ -171,7 +173,7 @@ public:
 		const float CosTheta = AbsCosTheta(Wh);
 
 		// Compute PDF for $\wi$ from Blinn distribution
-		float Pdf = ((this->Exponent + 1.0f) * powf(CosTheta, this->Exponent)) / (2.0f * PI_F * 4.0f * Dot(Wo, Wh));
+		float Pdf = ((this->Exponent + 1.0f) * Pow(CosTheta, this->Exponent, this->Accuracy)) / (2.0f * PI_F * 4.0f * Dot(Wo, Wh));
 
 		if (Dot(Wo, Wh) <= 0.0f)
 			Pdf = 0.0f;
@@ -182,17 +184,19 @@ public:
 	HOST_DEVICE float D(const Vec3f& Wh)
 	{
 		float CosThetaH = AbsCosTheta(Wh);
-		return (this->Exponent + 2) * INV_TWO_PI_F * powf(CosThetaH, this->Exponent);
+		return (this->Exponent + 2) * INV_TWO_PI_F * Pow(CosThetaH, this->Exponent, this->Accuracy);
 	}
 
 	HOST_DEVICE Blinn& operator = (const Blinn& Other)
 	{
 		this->Exponent = Other.Exponent;
+		this->Accuracy = Other.Accuracy;
 
 		return *this;
 	}
 
 	float	Exponent;
+	int		Accuracy;
 };
 
 class Microfacet
@@ -202,10 +206,10 @@ public:
 	{
 	}
 
-	HOST_DEVICE Microfacet(const ColorXYZf& Reflectance, const float& Ior, const float& Exponent) :
+	HOST_DEVICE Microfacet(const ColorXYZf& Reflectance, const float& Ior, const float& Exponent, const int& Accuracy = Enums::ExactMath) :
 		R(Reflectance),
 		Fresnel(1.0f, Ior),
-		Blinn(Exponent)
+		Blinn(Exponent, Accuracy)
 	{
 	}
 
@@ -320,9 +324,9 @@ public:
 	{
 	}
 
-	HOST_DEVICE BRDF(const Vec3f& N, const Vec3f& Wo, const ColorXYZf& Kd, const ColorXYZf& Ks, const float& Ior, const float& Exponent) :
+	HOST_DEVICE BRDF(const Vec3f& N, const Vec3f& Wo, const ColorXYZf& Kd, const ColorXYZf& Ks, const float& Ior, const float& Exponent, const int& Accuracy = Enums::ExactMath) :
 		Lambertian(Kd),
-		Microfacet(Ks, Ior, Exponent),
+		Microfacet(Ks, Ior, Exponent, Accuracy),
 		Nn(Normalize(N)),
 		Nu(Normalize(Cross(N, Wo))),
 		Nv(Normalize(Cross(N, Nu)))
@@ -482,4 +486,129 @@ public:
 	IsotropicPhase				IsotropicPhase;
 };
 
+/*
+	Lambertian only shader, for materials without specular reflection. It evaluates like the full BRDF with a black
+	Ks, the pdf keeps the Blinn lobe of the BRDF so light samples get the same weights. Only sampling needs the local frame
+*/
+class DiffuseShader
+{
+public:
+	HOST_DEVICE DiffuseShader(const Vec3f& N, const ColorXYZf& Kd, const float& Exponent, const int& Accuracy = Enums::ExactMath) :
+		Type(Enums::Brdf),
+		N(Normalize(N)),
+		Lambertian(Kd),
+		Exponent(Exponent),
+		Accuracy(Accuracy)
+	{
+	}
+
+	HOST_DEVICE ColorXYZf F(const Vec3f& Wo, const Vec3f& Wi)
+	{
+		return this->Lambertian.Kd * INV_PI_F;
+	}
+
+	HOST_DEVICE ColorXYZf SampleF(const Vec3f& Wo, Vec3f& Wi, float& Pdf, const BrdfSample& S)
+	{
+		const Vec3f Nu = Normalize(Cross(this->N, Wo));
+		const Vec3f Nv = Normalize(Cross(this->N, Nu));
+
+		const Vec3f Wol(Dot(Wo, Nu), Dot(Wo, Nv), Dot(Wo, this->N));
+
+		Vec3f Wil;
+
+		const ColorXYZf F = this->Lambertian.SampleF(Wol, Wil, Pdf, S.Dir);
+
+		Wi = Nu * Wil[0] + Nv * Wil[1] + this->N * Wil[2];
+
+		return F;
+	}
+
+	/*
+		Lambertian plus Blinn pdf, the same mixture as BRDF::Pdf evaluated in world space
+	*/
+	HOST_DEVICE float Pdf(const Vec3f& Wo, const Vec3f& Wi)
+	{
+		const float CosThetaI = Dot(Wi, this->N);
+
+		if (Dot(Wo, this->N) * CosThetaI <= 0.0f)
+			return 0.0f;
+
+		float Pdf = fabsf(CosThetaI) * INV_PI_F;
+
+		const Vec3f Wh = Normalize(Wo + Wi);
+
+		const float CosThetaOH = Dot(Wo, Wh);
+
+		if (CosThetaOH > 0.0f)
+			Pdf += ((this->Exponent + 1.0f) * Pow(fabsf(Dot(Wh, this->N)), this->Exponent, this->Accuracy)) / (2.0f * PI_F * 4.0f * CosThetaOH);
+
+		return Pdf;
+	}
+
+	Enums::ScatterFunction		Type;
+	Vec3f						N;
+	Lambertian					Lambertian;
+	float						Exponent;
+	int							Accuracy;
+};
+
+/*
+	Full BRDF without the phase function, so evaluation does not switch on the scatter function
+*/
+class SurfaceShader
+{
+public:
+	HOST_DEVICE SurfaceShader(const Vec3f& N, const Vec3f& Wo, const ColorXYZf& Kd, const ColorXYZf& Ks, const float& Ior, const float& Exponent, const int& Accuracy = Enums::ExactMath) :
+		Type(Enums::Brdf),
+		BRDF(N, Wo, Kd, Ks, Ior, Exponent, Accuracy)
+	{
+	}
+
+	HOST_DEVICE ColorXYZf F(const Vec3f& Wo, const Vec3f& Wi)
+	{
+		return this->BRDF.F(Wo, Wi);
+	}
+
+	HOST_DEVICE ColorXYZf SampleF(const Vec3f& Wo, Vec3f& Wi, float& Pdf, const BrdfSample& S)
+	{
+		return this->BRDF.SampleF(Wo, Wi, Pdf, S);
+	}
+
+	HOST_DEVICE float Pdf(const Vec3f& Wo, const Vec3f& Wi)
+	{
+		return this->BRDF.Pdf(Wo, Wi);
+	}
+
+	Enums::ScatterFunction		Type;
+	BRDF						BRDF;
+};
+
+class PhaseShader
+{
+public:
+	HOST_DEVICE PhaseShader(const ColorXYZf& Kd) :
+		Type(Enums::PhaseFunction),
+		IsotropicPhase(Kd)
+	{
+	}
+
+	HOST_DEVICE ColorXYZf F(const Vec3f& Wo, const Vec3f& Wi)
+	{
+		return this->IsotropicPhase.F(Wo, Wi);
+	}
+
+	HOST_DEVICE ColorXYZf SampleF(const Vec3f& Wo, Vec3f& Wi, float& Pdf, const BrdfSample& S)
+	{
+		return this->IsotropicPhase.SampleF(Wo, Wi, Pdf, S.Dir);
+	}
+
+	HOST_DEVICE float Pdf(const Vec3f& Wo, const Vec3f& Wi)
+	{
+		return this->IsotropicPhase.Pdf(Wo, Wi);
+	}
+
+	Enums::ScatterFunction		Type;
+	IsotropicPhase				IsotropicPhase;
+};
+
 }
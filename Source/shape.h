@@ -102,6 +102,43 @@ public:
 		}
 	}
 
+	/*
+		World space bounding box of the shape, padded so that flat shapes still have some extent
+	*/
+	HOST void GetBounds(Vec3f& Min, Vec3f& Max) const
+	{
+		Vec3f Extent;
+
+		switch (this->Type)
+		{
+			case Enums::Plane:		Extent = Vec3f(0.5f * this->Size[0], 0.5f * this->Size[1], 0.0f);				break;
+			case Enums::Disk:
+			case Enums::Ring:		Extent = Vec3f(this->OuterRadius, this->OuterRadius, 0.0f);						break;
+			case Enums::Box:		Extent = 0.5f * this->Size;														break;
+			case Enums::Sphere:		Extent = Vec3f(this->OuterRadius);												break;
+			default:				Extent = Vec3f(this->OuterRadius, this->OuterRadius, 0.5f * this->Size[2]);		break;
+		}
+
+		Min = Vec3f(FLT_MAX);
+		Max = Vec3f(-FLT_MAX);
+
+		for (int i = 0; i < 8; i++)
+		{
+			const Vec3f P((i & 1) ? Extent[0] : -Extent[0], (i & 2) ? Extent[1] : -Extent[1], (i & 4) ? Extent[2] : -Extent[2]);
+
+			for (int j = 0; j < 3; j++)
+			{
+				const float Pt = this->TM.NN[j][0] * P[0] + this->TM.NN[j][1] * P[1] + this->TM.NN[j][2] * P[2] + this->TM.NN[j][3];
+
+				Min[j] = fminf(Min[j], Pt);
+				Max[j] = fmaxf(Max[j], Pt);
+			}
+		}
+
+		Min = Min - Vec3f(RAY_EPS);
+		Max = Max + Vec3f(RAY_EPS);
+	}
+
 	Matrix44			TM;
 	Matrix44			InvTM;
 	bool				OneSided;
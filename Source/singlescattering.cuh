@@ -20,21 +20,102 @@
 
 #include "macros.cuh"
 #include "singlescattering.h"
+#include "wavefront.cuh"
 
 namespace ExposureRender
 {
 
+template<int Variant>
 KERNEL void KrnlSingleScattering()
 {
 	KERNEL_2D(gpTracer->FrameBuffer.Resolution[0], gpTracer->FrameBuffer.Resolution[1])
 
-	gpTracer->FrameBuffer.FrameEstimate(IDx, IDy) = SingleScattering(gpTracer, Vec2i(IDx, IDy));
+	gpTracer->FrameBuffer.FrameEstimate(IDx, IDy) = SingleScattering<Variant>(gpTracer, Vec2i(IDx, IDy));
 }
 
+template<int Variant>
+void LaunchSingleScattering(Tracer& Tracer, const char* pTitle)
+{
+	if (Tracer.RenderSettings.Traversal.Wavefront)
+	{
+		RenderWavefront<Variant | Enums::WavefrontVariant>(Tracer, pTitle);
+		return;
+	}
+
+	// 8 x 16 blocks, so that a warp covers an 8 x 4 pixel tile instead of a 16 x 2 strip
+	LAUNCH_DIMENSIONS(Tracer.FrameBuffer.Resolution[0], Tracer.FrameBuffer.Resolution[1], 1, 8, 16, 1)
+	LAUNCH_CUDA_KERNEL_TIMED((KrnlSingleScattering<Variant><<<GridDim, BlockDim>>>()), pTitle)
+}
+
+/*
+	Launches the instantiation of a shading variant that also has shadows and the camera aperture
+	compiled in, so the inner loops carry no branches on these settings
+*/
+template<int ShadingVariant>
+void SingleScattering(Tracer& Tracer, const char* pTitle)
+{
+	const bool Shadows	= Tracer.RenderSettings.Traversal.Shadows;
+	const bool Aperture	= Tracer.Camera.ApertureSize != 0.0f;
+
+	if (Shadows && Aperture)
+		LaunchSingleScattering<ShadingVariant | Enums::ShadowsVariant | Enums::ApertureVariant>(Tracer, pTitle);
+	else if (Shadows)
+		LaunchSingleScattering<ShadingVariant | Enums::ShadowsVariant>(Tracer, pTitle);
+	else if (Aperture)
+		LaunchSingleScattering<ShadingVariant | Enums::ApertureVariant>(Tracer, pTitle);
+	else
+		LaunchSingleScattering<ShadingVariant>(Tracer, pTitle);
+}
+
+/*
+	Dispatches once per frame on the shading variant of the tracer, phase function shading ignores
+	specular reflection so those variants are not instantiated. The hybrid variants choose between
+	the surface shader and the phase function per scatter event
+*/
 void SingleScattering(Tracer& Tracer)
 {
-	LAUNCH_DIMENSIONS(Tracer.FrameBuffer.Resolution[0], Tracer.FrameBuffer.Resolution[1], 1, 16, 8, 1)
-	LAUNCH_CUDA_KERNEL_TIMED((KrnlSingleScattering<<<GridDim, BlockDim>>>()), "Single Scattering"); 
+	switch (Tracer.ShadingVariant)
+	{
+		case Enums::DiffuseShading:
+			SingleScattering<Enums::DiffuseShading>(Tracer, "Single Scattering (Diffuse)");
+			break;
+
+		case Enums::SpecularShading:
+			SingleScattering<Enums::SpecularShading>(Tracer, "Single Scattering (Specular)");
+			break;
+
+		case Enums::DiffuseShading | Enums::EmissiveShading:
+			SingleScattering<Enums::DiffuseShading | Enums::EmissiveShading>(Tracer, "Single Scattering (Diffuse, Emissive)");
+			break;
+
+		case Enums::SpecularShading | Enums::EmissiveShading:
+			SingleScattering<Enums::SpecularShading | Enums::EmissiveShading>(Tracer, "Single Scattering (Specular, Emissive)");
+			break;
+
+		case Enums::PhaseShading:
+			SingleScattering<Enums::PhaseShading>(Tracer, "Single Scattering (Phase)");
+			break;
+
+		case Enums::PhaseShading | Enums::EmissiveShading:
+			SingleScattering<Enums::PhaseShading | Enums::EmissiveShading>(Tracer, "Single Scattering (Phase, Emissive)");
+			break;
+
+		case Enums::HybridShading:
+			SingleScattering<Enums::HybridShading>(Tracer, "Single Scattering (Hybrid)");
+			break;
+
+		case Enums::HybridShading | Enums::SpecularShading:
+			SingleScattering<Enums::HybridShading | Enums::SpecularShading>(Tracer, "Single Scattering (Hybrid, Specular)");
+			break;
+
+		case Enums::HybridShading | Enums::EmissiveShading:
+			SingleScattering<Enums::HybridShading | Enums::EmissiveShading>(Tracer, "Single Scattering (Hybrid, Emissive)");
+			break;
+
+		case Enums::HybridShading | Enums::SpecularShading | Enums::EmissiveShading:
+			SingleScattering<Enums::HybridShading | Enums::SpecularShading | Enums::EmissiveShading>(Tracer, "Single Scattering (Hybrid, Specular, Emissive)");
+			break;
+	}
 }
 
 }
@@ -26,6 +26,7 @@
 namespace ExposureRender
 {
 
+template<int Variant>
 HOST_DEVICE_NI void SampleCamera(const Camera& Camera, Ray& R, const int& U, const int& V, CameraSample& CS)
 {
 	Vec2f ScreenPoint;
@@ -38,9 +39,9 @@ HOST_DEVICE_NI void SampleCamera(const Camera& Camera, Ray& R, const int& U, con
 	R.MinT	= Camera.ClipNear;
 	R.MaxT	= Camera.ClipFar;
 
-	if (Camera.ApertureSize != 0.0f)
+	if (Variant & Enums::ApertureVariant)
 	{
-		const Vec2f LensUV = Camera.ApertureSize * ConcentricSampleDisk(CS.LensUV);
+		const Vec2f LensUV = Camera.ApertureSize * ConcentricSampleDisk(CS.LensUV, gpTracer->RenderSettings.Shading.MathAccuracy);
 
 		const Vec3f LI = Camera.U * LensUV[0] + Camera.V * LensUV[1];
 
@@ -73,6 +74,7 @@ HOST_DEVICE_NI ScatterEvent SampleRay(Ray R, CRNG& RNG)
 	return NearestRS;
 }
 
+template<int Variant>
 HOST_DEVICE_NI ColorXYZAf SingleScattering(Tracer* pTracer, const Vec2i& PixelCoord)
 {
 	CRNG RNG(&gpTracer->FrameBuffer.RandomSeeds1(PixelCoord[0], PixelCoord[1]), &gpTracer->FrameBuffer.RandomSeeds2(PixelCoord[0], PixelCoord[1]));
@@ -83,20 +85,25 @@ HOST_DEVICE_NI ColorXYZAf SingleScattering(Tracer* pTracer, const Vec2i& PixelCo
 
 	Ray R;
 
-	SampleCamera(gpTracer->Camera, R, PixelCoord[0], PixelCoord[1], Sample.CameraSample);
+	SampleCamera<Variant>(gpTracer->Camera, R, PixelCoord[0], PixelCoord[1], Sample.CameraSample);
 
 	ScatterEvent SE;
 
 	SE = SampleRay(R, RNG);
 
+	ShadowRay Shadow;
+
 	if (SE.Valid && SE.Type == Enums::Volume)
-		Lv += UniformSampleOneLight(SE, RNG, Sample.LightingSample);
+		Lv += SampleOneLight<Variant>(SE, RNG, Sample.LightingSample, Shadow);
 
 	if (SE.Valid && SE.Type == Enums::Light)
 		Lv += SE.Le;
 	
 	if (SE.Valid && SE.Type == Enums::Object)
-		Lv += UniformSampleOneLight(SE, RNG, Sample.LightingSample);
+		Lv += SampleOneLight<Variant>(SE, RNG, Sample.LightingSample, Shadow);
+
+	if (!SE.Valid && EnvironmentRadiance(R.D, Lv))
+		return ColorXYZAf(Lv[0], Lv[1], Lv[2], 1.0f);
 
 	return ColorXYZAf(Lv[0], Lv[1], Lv[2], SE.Valid ? 1.0f : 0.0f);
 }
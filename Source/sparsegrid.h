@@ -0,0 +1,252 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "buffer3d.h"
+#include "geometry.h"
+
+#include <vector>
+
+namespace ExposureRender
+{
+
+#define SPARSE_NODE_VOXELS			(SPARSE_NODE_SIZE * SPARSE_BRICK_SIZE)
+#define SPARSE_NO_NODE_CHILDREN		(SPARSE_NODE_SIZE * SPARSE_NODE_SIZE * SPARSE_NODE_SIZE)
+#define SPARSE_NO_BRICK_VOXELS		(SPARSE_BRICK_SIZE * SPARSE_BRICK_SIZE * SPARSE_BRICK_SIZE)
+
+/*
+	Fixed depth sparse voxel tree. A dense root grid points to internal nodes, each internal node
+	holds SPARSE_NODE_SIZE^3 child slots that point to dense bricks of SPARSE_BRICK_SIZE^3 voxels.
+	Bricks and nodes that only contain background voxels are not stored (index -1)
+*/
+class EXPOSURE_RENDER_DLL SparseGrid
+{
+public:
+	HOST SparseGrid() :
+		Enabled(false),
+		Resolution(0),
+		Background(0),
+		Root(Enums::Device, "Device Sparse Root"),
+		Nodes(Enums::Device, "Device Sparse Nodes"),
+		Bricks(Enums::Device, "Device Sparse Bricks")
+	{
+	}
+
+	HOST virtual ~SparseGrid(void)
+	{
+	}
+
+	HOST SparseGrid(const SparseGrid& Other) :
+		Enabled(false),
+		Resolution(0),
+		Background(0),
+		Root(Enums::Device, "Device Sparse Root"),
+		Nodes(Enums::Device, "Device Sparse Nodes"),
+		Bricks(Enums::Device, "Device Sparse Bricks")
+	{
+		*this = Other;
+	}
+
+	HOST SparseGrid& SparseGrid::operator = (const SparseGrid& Other)
+	{
+		this->Enabled		= Other.Enabled;
+		this->Resolution	= Other.Resolution;
+		this->Background	= Other.Background;
+		this->Root			= Other.Root;
+		this->Nodes			= Other.Nodes;
+		this->Bricks		= Other.Bricks;
+
+		return *this;
+	}
+
+	HOST void Build(const Buffer3D<unsigned short>& Voxels, const unsigned short& Background)
+	{
+		DebugLog(__FUNCTION__);
+
+		this->Enabled		= true;
+		this->Resolution	= Voxels.Resolution;
+		this->Background	= Background;
+
+		const Vec3i RootResolution((this->Resolution[0] + SPARSE_NODE_VOXELS - 1) / SPARSE_NODE_VOXELS, (this->Resolution[1] + SPARSE_NODE_VOXELS - 1) / SPARSE_NODE_VOXELS, (this->Resolution[2] + SPARSE_NODE_VOXELS - 1) / SPARSE_NODE_VOXELS);
+		const Vec3i NoBricks((this->Resolution[0] + SPARSE_BRICK_SIZE - 1) / SPARSE_BRICK_SIZE, (this->Resolution[1] + SPARSE_BRICK_SIZE - 1) / SPARSE_BRICK_SIZE, (this->Resolution[2] + SPARSE_BRICK_SIZE - 1) / SPARSE_BRICK_SIZE);
+
+		vector<int>				Root(RootResolution[0] * RootResolution[1] * RootResolution[2], -1);
+		vector<int>				Nodes;
+		vector<unsigned short>	Bricks;
+
+		unsigned short Brick[SPARSE_NO_BRICK_VOXELS];
+
+		for (int BZ = 0; BZ < NoBricks[2]; BZ++)
+		{
+			for (int BY = 0; BY < NoBricks[1]; BY++)
+			{
+				for (int BX = 0; BX < NoBricks[0]; BX++)
+				{
+					bool Occupied = false;
+
+					for (int Z = 0; Z < SPARSE_BRICK_SIZE; Z++)
+					{
+						for (int Y = 0; Y < SPARSE_BRICK_SIZE; Y++)
+						{
+							for (int X = 0; X < SPARSE_BRICK_SIZE; X++)
+							{
+								const Vec3i XYZ(BX * SPARSE_BRICK_SIZE + X, BY * SPARSE_BRICK_SIZE + Y, BZ * SPARSE_BRICK_SIZE + Z);
+
+								const bool Inside = XYZ[0] < this->Resolution[0] && XYZ[1] < this->Resolution[1] && XYZ[2] < this->Resolution[2];
+
+								const unsigned short Voxel = Inside ? Voxels(XYZ) : Background;
+
+								Brick[(Z * SPARSE_BRICK_SIZE + Y) * SPARSE_BRICK_SIZE + X] = Voxel;
+
+								if (Voxel != Background)
+									Occupied = true;
+							}
+						}
+					}
+
+					if (!Occupied)
+						continue;
+
+					const int RootID = ((BZ / SPARSE_NODE_SIZE) * RootResolution[1] + BY / SPARSE_NODE_SIZE) * RootResolution[0] + BX / SPARSE_NODE_SIZE;
+
+					if (Root[RootID] < 0)
+					{
+						Root[RootID] = (int)(Nodes.size() / SPARSE_NO_NODE_CHILDREN);
+						Nodes.resize(Nodes.size() + SPARSE_NO_NODE_CHILDREN, -1);
+					}
+
+					const int ChildID = ((BZ % SPARSE_NODE_SIZE) * SPARSE_NODE_SIZE + BY % SPARSE_NODE_SIZE) * SPARSE_NODE_SIZE + BX % SPARSE_NODE_SIZE;
+
+					Nodes[Root[RootID] * SPARSE_NO_NODE_CHILDREN + ChildID] = (int)(Bricks.size() / SPARSE_NO_BRICK_VOXELS);
+					Bricks.insert(Bricks.end(), Brick, Brick + SPARSE_NO_BRICK_VOXELS);
+				}
+			}
+		}
+
+		const int NoNodes			= (int)(Nodes.size() / SPARSE_NO_NODE_CHILDREN);
+		const int NoOccupiedBricks	= (int)(Bricks.size() / SPARSE_NO_BRICK_VOXELS);
+
+		this->Root.Set(Enums::Host, RootResolution, &Root[0]);
+		this->Nodes.Set(Enums::Host, Vec3i(SPARSE_NO_NODE_CHILDREN, NoNodes, 1), NoNodes > 0 ? &Nodes[0] : NULL);
+		this->Bricks.Set(Enums::Host, Vec3i(SPARSE_NO_BRICK_VOXELS, NoOccupiedBricks, 1), NoOccupiedBricks > 0 ? &Bricks[0] : NULL);
+
+		DebugLog("%d nodes, %d of %d bricks occupied", NoNodes, NoOccupiedBricks, NoBricks[0] * NoBricks[1] * NoBricks[2]);
+	}
+
+	HOST void Free(void)
+	{
+		this->Enabled = false;
+
+		this->Root.Free();
+		this->Nodes.Free();
+		this->Bricks.Free();
+	}
+
+	HOST_DEVICE unsigned short operator()(const int& X, const int& Y, const int& Z) const
+	{
+		const Vec3i XYZ(Clamp(X, 0, this->Resolution[0] - 1), Clamp(Y, 0, this->Resolution[1] - 1), Clamp(Z, 0, this->Resolution[2] - 1));
+
+		const int NodeID = this->Root(XYZ[0] / SPARSE_NODE_VOXELS, XYZ[1] / SPARSE_NODE_VOXELS, XYZ[2] / SPARSE_NODE_VOXELS);
+
+		if (NodeID < 0)
+			return this->Background;
+
+		const int BrickID = this->Nodes.Data[NodeID * SPARSE_NO_NODE_CHILDREN + this->ChildID(XYZ)];
+
+		if (BrickID < 0)
+			return this->Background;
+
+		const Vec3i Local(XYZ[0] % SPARSE_BRICK_SIZE, XYZ[1] % SPARSE_BRICK_SIZE, XYZ[2] % SPARSE_BRICK_SIZE);
+
+		return this->Bricks.Data[BrickID * SPARSE_NO_BRICK_VOXELS + (Local[2] * SPARSE_BRICK_SIZE + Local[1]) * SPARSE_BRICK_SIZE + Local[0]];
+	}
+
+	HOST_DEVICE unsigned short operator()(const Vec3f& XYZ) const
+	{
+		const int vx = (int)floorf(XYZ[0]);
+		const int vy = (int)floorf(XYZ[1]);
+		const int vz = (int)floorf(XYZ[2]);
+
+		const float dx = XYZ[0] - vx;
+		const float dy = XYZ[1] - vy;
+		const float dz = XYZ[2] - vz;
+
+		const float d00 = Lerp(dx, (float)(*this)(vx, vy, vz), (float)(*this)(vx+1, vy, vz));
+		const float d10 = Lerp(dx, (float)(*this)(vx, vy+1, vz), (float)(*this)(vx+1, vy+1, vz));
+		const float d01 = Lerp(dx, (float)(*this)(vx, vy, vz+1), (float)(*this)(vx+1, vy, vz+1));
+		const float d11 = Lerp(dx, (float)(*this)(vx, vy+1, vz+1), (float)(*this)(vx+1, vy+1, vz+1));
+		const float d0	= Lerp(dy, d00, d10);
+		const float d1 	= Lerp(dy, d01, d11);
+
+		return (unsigned short)Lerp(dz, d0, d1);
+	}
+
+	/*
+		Returns the empty node or brick that contains voxel coordinate XYZ, shrunk by one voxel on
+		its upper faces so that trilinear lookups anywhere inside the box only touch background voxels
+	*/
+	HOST_DEVICE bool GetEmptyBox(const Vec3f& XYZ, Vec3f& Min, Vec3f& Max) const
+	{
+		if (XYZ[0] < 0.0f || XYZ[1] < 0.0f || XYZ[2] < 0.0f)
+			return false;
+
+		const Vec3i Voxel((int)XYZ[0], (int)XYZ[1], (int)XYZ[2]);
+
+		if (Voxel[0] >= this->Resolution[0] || Voxel[1] >= this->Resolution[1] || Voxel[2] >= this->Resolution[2])
+			return false;
+
+		int Size = SPARSE_NODE_VOXELS;
+
+		const int NodeID = this->Root(Voxel[0] / SPARSE_NODE_VOXELS, Voxel[1] / SPARSE_NODE_VOXELS, Voxel[2] / SPARSE_NODE_VOXELS);
+
+		if (NodeID >= 0)
+		{
+			if (this->Nodes.Data[NodeID * SPARSE_NO_NODE_CHILDREN + this->ChildID(Voxel)] >= 0)
+				return false;
+
+			Size = SPARSE_BRICK_SIZE;
+		}
+
+		for (int i = 0; i < 3; i++)
+		{
+			Min[i] = (float)((Voxel[i] / Size) * Size);
+			Max[i] = Min[i] + (float)(Size - 1);
+
+			if (XYZ[i] > Max[i])
+				return false;
+		}
+
+		return true;
+	}
+
+	bool						Enabled;
+	Vec3i						Resolution;
+	unsigned short				Background;
+	Buffer3D<int>				Root;
+	Buffer3D<int>				Nodes;
+	Buffer3D<unsigned short>	Bricks;
+
+private:
+	HOST_DEVICE int ChildID(const Vec3i& XYZ) const
+	{
+		return (((XYZ[2] / SPARSE_BRICK_SIZE) % SPARSE_NODE_SIZE) * SPARSE_NODE_SIZE + (XYZ[1] / SPARSE_BRICK_SIZE) % SPARSE_NODE_SIZE) * SPARSE_NODE_SIZE + (XYZ[0] / SPARSE_BRICK_SIZE) % SPARSE_NODE_SIZE;
+	}
+};
+
+}
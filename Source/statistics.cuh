@@ -0,0 +1,187 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "macros.cuh"
+#include "volume.h"
+
+namespace ExposureRender
+{
+
+#define STATISTICS_BLOCK_SIZE		8
+#define HISTOGRAM_BLOCK_SIZE		256
+#define HISTOGRAM_MAX_NO_BLOCKS		1024
+
+DEVICE float VoxelGradientMagnitude(const Volume& Volume, const int& X, const int& Y, const int& Z)
+{
+	const float D[3] =
+	{
+		((float)Volume.GetVoxel(X + 1, Y, Z) - (float)Volume.GetVoxel(X - 1, Y, Z)) * 0.5f * Volume.InvSpacing[0],
+		((float)Volume.GetVoxel(X, Y + 1, Z) - (float)Volume.GetVoxel(X, Y - 1, Z)) * 0.5f * Volume.InvSpacing[1],
+		((float)Volume.GetVoxel(X, Y, Z + 1) - (float)Volume.GetVoxel(X, Y, Z - 1)) * 0.5f * Volume.InvSpacing[2]
+	};
+
+	return sqrtf(D[0] * D[0] + D[1] * D[1] + D[2] * D[2]);
+}
+
+/*
+	Each block reduces the intensity and gradient magnitude range of its voxels in shared memory,
+	the block results are merged with atomics. Gradient magnitudes are non-negative, so their
+	bit patterns can be compared as unsigned integers. Only the Extent voxels from Offset are reduced
+*/
+KERNEL void KrnlComputeRanges(const Volume* pVolume, Vec3i Offset, Vec3i Extent, unsigned int* pRanges)
+{
+	const int IDx 	= Offset[0] + blockIdx.x * blockDim.x + threadIdx.x;
+	const int IDy 	= Offset[1] + blockIdx.y * blockDim.y + threadIdx.y;
+	const int IDz 	= Offset[2] + blockIdx.z * blockDim.z + threadIdx.z;
+	const int IDt	= threadIdx.z * blockDim.x * blockDim.y + threadIdx.y * blockDim.x + threadIdx.x;
+
+	const Vec3i End = Offset + Extent;
+
+	const int NoThreads = STATISTICS_BLOCK_SIZE * STATISTICS_BLOCK_SIZE * STATISTICS_BLOCK_SIZE;
+
+	__shared__ unsigned int Ranges[4][NoThreads];
+
+	Ranges[0][IDt] = 0xffffffff;
+	Ranges[1][IDt] = 0;
+	Ranges[2][IDt] = 0xffffffff;
+	Ranges[3][IDt] = 0;
+
+	if (IDx < End[0] && IDy < End[1] && IDz < End[2])
+	{
+		const unsigned int Intensity			= pVolume->GetVoxel(IDx, IDy, IDz);
+		const unsigned int GradientMagnitude	= (unsigned int)__float_as_int(VoxelGradientMagnitude(*pVolume, IDx, IDy, IDz));
+
+		Ranges[0][IDt] = Intensity;
+		Ranges[1][IDt] = Intensity;
+		Ranges[2][IDt] = GradientMagnitude;
+		Ranges[3][IDt] = GradientMagnitude;
+	}
+
+	__syncthreads();
+
+	for (int Stride = NoThreads / 2; Stride > 0; Stride >>= 1)
+	{
+		if (IDt < Stride)
+		{
+			Ranges[0][IDt] = min(Ranges[0][IDt], Ranges[0][IDt + Stride]);
+			Ranges[1][IDt] = max(Ranges[1][IDt], Ranges[1][IDt + Stride]);
+			Ranges[2][IDt] = min(Ranges[2][IDt], Ranges[2][IDt + Stride]);
+			Ranges[3][IDt] = max(Ranges[3][IDt], Ranges[3][IDt + Stride]);
+		}
+
+		__syncthreads();
+	}
+
+	if (IDt == 0)
+	{
+		atomicMin(&pRanges[0], Ranges[0][0]);
+		atomicMax(&pRanges[1], Ranges[1][0]);
+		atomicMin(&pRanges[2], Ranges[2][0]);
+		atomicMax(&pRanges[3], Ranges[3][0]);
+	}
+}
+
+KERNEL void KrnlComputeHistogram(const Volume* pVolume, Vec3i Offset, Vec3i Extent, float Min, float Inv, int* pHistogram)
+{
+	const int NoVoxels = Extent[0] * Extent[1] * Extent[2];
+
+	__shared__ int Bins[NO_HISTOGRAM_BINS];
+
+	for (int i = threadIdx.x; i < NO_HISTOGRAM_BINS; i += blockDim.x)
+		Bins[i] = 0;
+
+	__syncthreads();
+
+	for (int ID = blockIdx.x * blockDim.x + threadIdx.x; ID < NoVoxels; ID += blockDim.x * gridDim.x)
+	{
+		const int X = Offset[0] + ID % Extent[0];
+		const int Y = Offset[1] + (ID / Extent[0]) % Extent[1];
+		const int Z = Offset[2] + ID / (Extent[0] * Extent[1]);
+
+		const int Bin = (int)(((float)pVolume->GetVoxel(X, Y, Z) - Min) * Inv * (float)NO_HISTOGRAM_BINS);
+		atomicAdd(&Bins[Clamp(Bin, 0, NO_HISTOGRAM_BINS - 1)], 1);
+	}
+
+	__syncthreads();
+
+	for (int i = threadIdx.x; i < NO_HISTOGRAM_BINS; i += blockDim.x)
+		atomicAdd(&pHistogram[i], Bins[i]);
+}
+
+/*
+	Intensity and gradient magnitude range of the Extent voxels from Offset
+*/
+void ComputeRanges(const ExposureRender::Volume* pDeviceVolume, const Vec3i& Offset, const Vec3i& Extent, Range& IntensityRange, Range& GradientMagnitudeRange)
+{
+	unsigned int Ranges[4] = { 0xffffffff, 0, 0xffffffff, 0 };
+	
+	unsigned int* pRanges = NULL;
+
+	Cuda::Allocate(pRanges, 4);
+	Cuda::MemCopyHostToDevice(Ranges, pRanges, 4);
+
+	LAUNCH_DIMENSIONS(Extent[0], Extent[1], Extent[2], STATISTICS_BLOCK_SIZE, STATISTICS_BLOCK_SIZE, STATISTICS_BLOCK_SIZE)
+	LAUNCH_CUDA_KERNEL((KrnlComputeRanges<<<GridDim, BlockDim>>>(pDeviceVolume, Offset, Extent, pRanges)));
+
+	Cuda::MemCopyDeviceToHost(pRanges, Ranges, 4);
+	Cuda::Free(pRanges);
+
+	float GradientMagnitudes[2];
+
+	memcpy(&GradientMagnitudes[0], &Ranges[2], sizeof(float));
+	memcpy(&GradientMagnitudes[1], &Ranges[3], sizeof(float));
+
+	IntensityRange.Set((float)Ranges[0], (float)Ranges[1]);
+	GradientMagnitudeRange.Set(GradientMagnitudes[0], GradientMagnitudes[1]);
+}
+
+/*
+	Histogram of the Extent voxels from Offset over IntensityRange, written to the host array pBins
+*/
+void ComputeHistogram(const ExposureRender::Volume* pDeviceVolume, const Vec3i& Offset, const Vec3i& Extent, const Range& IntensityRange, int* pBins)
+{
+	const int NoVoxels = Extent[0] * Extent[1] * Extent[2];
+
+	int* pHistogram = NULL;
+
+	Cuda::Allocate(pHistogram, NO_HISTOGRAM_BINS);
+	Cuda::MemSet(pHistogram, 0, NO_HISTOGRAM_BINS);
+
+	LAUNCH_DIMENSIONS(min(NoVoxels, HISTOGRAM_BLOCK_SIZE * HISTOGRAM_MAX_NO_BLOCKS), 1, 1, HISTOGRAM_BLOCK_SIZE, 1, 1)
+	LAUNCH_CUDA_KERNEL((KrnlComputeHistogram<<<GridDim, BlockDim>>>(pDeviceVolume, Offset, Extent, IntensityRange.Min, IntensityRange.Inv, pHistogram)));
+
+	Cuda::MemCopyDeviceToHost(pHistogram, pBins, NO_HISTOGRAM_BINS);
+	Cuda::Free(pHistogram);
+}
+
+void ComputeStatistics(Volume& Volume, const ExposureRender::Volume* pDeviceVolume)
+{
+	const Vec3i Resolution = Volume.Resolution;
+
+	if (Resolution[0] * Resolution[1] * Resolution[2] <= 0)
+		return;
+
+	ComputeRanges(pDeviceVolume, Vec3i(0), Resolution, Volume.IntensityRange, Volume.GradientMagnitudeRange);
+	ComputeHistogram(pDeviceVolume, Vec3i(0), Resolution, Volume.IntensityRange, Volume.Histogram);
+
+	DebugLog("%s, intensity range = [%0.2f, %0.2f], gradient magnitude range = [%0.2f, %0.2f]", __FUNCTION__, Volume.IntensityRange.Min, Volume.IntensityRange.Max, Volume.GradientMagnitudeRange.Min, Volume.GradientMagnitudeRange.Max);
+}
+
+}
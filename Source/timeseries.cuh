@@ -0,0 +1,200 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "preprocess.cuh"
+
+#include <thread>
+
+namespace ExposureRender
+{
+
+namespace Cuda
+{
+
+/*
+	Double buffers the timepoints of a time series volume. While the current timepoint is being
+	rendered, the next one is uploaded into a staging volume by a background thread on its own
+	stream and preprocessed. Switching timepoints then only swaps the staging volume with the bound one.
+	The timepoints are page-locked so that their uploads are truly asynchronous, and everything the
+	background thread needs on the device is allocated up front, as allocations synchronize the device.
+	The renderer synchronizes the whole device after its launches and copies, so a frame rendered while a
+	prefetch is in flight still waits for the queued prefetch work. The thread saves the caller issuing the
+	upload and the preprocessing, and the synchronous upload when switching to a timepoint
+*/
+class TimeSeries
+{
+public:
+	HOST TimeSeries(const ErVolume& Volume) :
+		NoTimepoints(Volume.NoTimepoints),
+		Timepoint(0),
+		pNext(NULL),
+		NextTimepoint(-1),
+		Failed(false),
+		NoRegistered(0),
+		pDeviceNext(NULL),
+		pRanges(NULL),
+		pHistogram(NULL),
+		Stream(NULL),
+		Thread()
+	{
+		DebugLog("%s, No. timepoints = %d", __FUNCTION__, this->NoTimepoints);
+
+		for (int i = 0; i < this->NoTimepoints; i++)
+			this->Timepoints[i] = Volume.Timepoints[i];
+
+		const int NoVoxels = Volume.Voxels.Resolution[0] * Volume.Voxels.Resolution[1] * Volume.Voxels.Resolution[2];
+
+		try
+		{
+			for (; this->NoRegistered < this->NoTimepoints; this->NoRegistered++)
+				Cuda::HostRegister(this->Timepoints[this->NoRegistered], NoVoxels);
+		}
+		catch (Exception& Exception)
+		{
+			DebugLog("%s, timepoints could not be page-locked, remaining uploads fall back to pageable copies, %s", __FUNCTION__, Exception.Message);
+		}
+
+		Cuda::Allocate(this->pRanges, 4);
+		Cuda::Allocate(this->pHistogram, NO_HISTOGRAM_BINS);
+		Cuda::Allocate(this->pDeviceNext);
+
+		Cuda::CreateStream(this->Stream);
+	}
+
+	HOST ~TimeSeries()
+	{
+		DebugLog(__FUNCTION__);
+
+		this->Wait();
+
+		delete this->pNext;
+
+		Cuda::Free(this->pRanges);
+		Cuda::Free(this->pHistogram);
+		Cuda::Free(this->pDeviceNext);
+
+		for (int i = 0; i < this->NoRegistered; i++)
+			Cuda::HostUnregister(this->Timepoints[i]);
+
+		Cuda::DestroyStream(this->Stream);
+	}
+
+	HOST void Prefetch(const Volume& Current, const int& Timepoint)
+	{
+		DebugLog("%s, Timepoint = %d", __FUNCTION__, Timepoint);
+
+		this->Wait();
+
+		if (Timepoint == this->NextTimepoint && !this->Failed)
+			return;
+
+		// Device allocations are synchronous, so the staging volume is prepared on the calling thread
+		if (this->pNext == NULL)
+			this->pNext = new Volume();
+
+		this->pNext->Reshape(Current);
+
+		AllocateDerivedVolumes(*this->pNext);
+
+		Cuda::MemCopyHostToDevice(this->pNext, this->pDeviceNext);
+
+		this->NextTimepoint	= Timepoint;
+		this->Failed		= false;
+
+		this->Thread = std::thread(&TimeSeries::Load, this);
+	}
+
+	HOST void Swap(Volume*& pCurrent, const int& Timepoint)
+	{
+		DebugLog("%s, Timepoint = %d", __FUNCTION__, Timepoint);
+
+		this->Wait();
+
+		if (Timepoint == this->Timepoint)
+			return;
+
+		if (Timepoint != this->NextTimepoint || this->Failed)
+		{
+			DebugLog("Timepoint %d was not prefetched, uploading synchronously", Timepoint);
+
+			if (this->pNext == NULL)
+				this->pNext = new Volume();
+
+			this->pNext->Reshape(*pCurrent);
+
+			Cuda::MemCopyHostToDevice(this->Timepoints[Timepoint], this->pNext->Voxels.Data, this->pNext->Voxels.GetNoElements());
+
+			PreprocessVolume(*this->pNext);
+		}
+
+		Volume* pPrevious = pCurrent;
+
+		pCurrent		= this->pNext;
+		this->pNext		= pPrevious;
+
+		this->Timepoint		= Timepoint;
+		this->NextTimepoint	= -1;
+	}
+
+	HOST int GetNextTimepoint(const int& Timepoint) const
+	{
+		return (Timepoint + 1) % this->NoTimepoints;
+	}
+
+	unsigned short*		Timepoints[MAX_NO_TIMEPOINTS];
+	int					NoTimepoints;
+	int					Timepoint;
+
+private:
+	HOST void Load()
+	{
+		try
+		{
+			Cuda::MemCopyHostToDeviceAsync(this->Timepoints[this->NextTimepoint], this->pNext->Voxels.Data, this->pNext->Voxels.GetNoElements(), this->Stream);
+
+			PreprocessVolumeAsync(*this->pNext, this->pDeviceNext, this->pRanges, this->pHistogram, this->Stream);
+		}
+		catch (Exception& Exception)
+		{
+			DebugLog("%s failed, %s", __FUNCTION__, Exception.Message);
+			this->Failed = true;
+		}
+	}
+
+	HOST void Wait()
+	{
+		if (this->Thread.joinable())
+			this->Thread.join();
+	}
+
+	Volume*			pNext;
+	int				NextTimepoint;
+	bool			Failed;
+	int				NoRegistered;
+	Volume*			pDeviceNext;
+	unsigned int*	pRanges;
+	int*			pHistogram;
+	cudaStream_t	Stream;
+	std::thread		Thread;
+};
+
+}
+
+}
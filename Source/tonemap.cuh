@@ -31,9 +31,12 @@ HOST_DEVICE ColorRGBuc ToneMap(const ColorXYZAf& XYZA)
 {
 	ColorRGBf RGBf = ColorRGBf::FromXYZAf(XYZA);
 
-	RGBf[0] = 1.0f - expf(-(RGBf[0] / gpTracer->Camera.Exposure));
-	RGBf[1] = 1.0f - expf(-(RGBf[1] / gpTracer->Camera.Exposure));
-	RGBf[2] = 1.0f - expf(-(RGBf[2] / gpTracer->Camera.Exposure));
+	const float InvExposure	= 1.0f / gpTracer->Camera.Exposure;
+	const int Accuracy		= gpTracer->RenderSettings.Shading.MathAccuracy;
+
+	RGBf[0] = 1.0f - Exp(-RGBf[0] * InvExposure, Accuracy);
+	RGBf[1] = 1.0f - Exp(-RGBf[1] * InvExposure, Accuracy);
+	RGBf[2] = 1.0f - Exp(-RGBf[2] * InvExposure, Accuracy);
 
 	RGBf.Clamp(0.0f, 1.0f);
 
@@ -20,6 +20,15 @@
 
 #include "ertracer.h"
 #include "framebuffer.h"
+#include "boundingbox.h"
+#include "buffer2d.h"
+#include "range.h"
+#include "materialtable.h"
+#include "transferfunctiontable.h"
+#include "wavefront.h"
+#include "aliastable.h"
+#include "lightbvh.h"
+#include "transmittancecache.h"
 
 #include <map>
 
@@ -33,11 +42,41 @@ class Tracer : public ErTracer
 public:
 	HOST Tracer() :
 		ErTracer(),
-		FrameBuffer()
+		FrameBuffer(),
+		VisibleBoundingBox(),
+		PreIntegrationRange(),
+		PreIntegratedOpacity(Enums::Device, "Pre-integrated Opacity"),
+		LabelTable(Enums::Device, "Device Labels"),
+		OpacityTable(),
+		MaterialTable(),
+		ShadingVariant(Enums::DiffuseShading),
+		ClassificationWindow(),
+		ClassifiedVoxels(Enums::Device, "Device Classified Voxels"),
+		Wavefront(),
+		LightDistribution(),
+		LightBVH(),
+		EnvironmentLightID(-1),
+		TransmittanceCache()
 	{
 	}
 
-	HOST Tracer(const ErTracer& Other)
+	HOST Tracer(const ErTracer& Other) :
+		ErTracer(),
+		FrameBuffer(),
+		VisibleBoundingBox(),
+		PreIntegrationRange(),
+		PreIntegratedOpacity(Enums::Device, "Pre-integrated Opacity"),
+		LabelTable(Enums::Device, "Device Labels"),
+		OpacityTable(),
+		MaterialTable(),
+		ShadingVariant(Enums::DiffuseShading),
+		ClassificationWindow(),
+		ClassifiedVoxels(Enums::Device, "Device Classified Voxels"),
+		Wavefront(),
+		LightDistribution(),
+		LightBVH(),
+		EnvironmentLightID(-1),
+		TransmittanceCache()
 	{
 		*this = Other;
 	}
@@ -48,10 +87,169 @@ public:
 		
 		this->FrameBuffer.Resize(Other.Camera.FilmSize);
 
+		this->Opacity2D.Bake();
+		this->Diffuse2D.Bake();
+
+		this->LabelTable = this->Labels;
+		this->OpacityTable.Bake(this->Opacity1D);
+		this->MaterialTable.Bake(this->Opacity1D, this->Diffuse1D, this->Specular1D, this->Glossiness1D, this->Emission1D, this->Opacity2D.Enabled());
+
+		this->UpdateShadingVariant();
+		this->UpdateWavefront();
+
 		return *this;
 	}
 
-	FrameBuffer	FrameBuffer;
+	/*
+		Copies only the parts of Other flagged in Changes (a combination of Enums::TracerChange) and
+		rebakes only the tables that depend on them. The running estimate restarts, but the frame
+		buffer is only reallocated when the film size changes
+	*/
+	HOST void Update(const ErTracer& Other, const int& Changes)
+	{
+		if (Changes & Enums::OpacityChanged)
+		{
+			this->Opacity1D = Other.Opacity1D;
+			this->Opacity2D = Other.Opacity2D;
+
+			this->Opacity2D.Bake();
+
+			this->OpacityTable.Bake(this->Opacity1D);
+		}
+
+		if (Changes & Enums::ColorChanged)
+		{
+			this->Diffuse1D		= Other.Diffuse1D;
+			this->Specular1D	= Other.Specular1D;
+			this->Glossiness1D	= Other.Glossiness1D;
+			this->Emission1D	= Other.Emission1D;
+			this->Diffuse2D		= Other.Diffuse2D;
+
+			this->Diffuse2D.Bake();
+		}
+
+		if (Changes & (Enums::OpacityChanged | Enums::ColorChanged))
+			this->MaterialTable.Bake(this->Opacity1D, this->Diffuse1D, this->Specular1D, this->Glossiness1D, this->Emission1D, this->Opacity2D.Enabled());
+
+		if (Changes & Enums::CameraChanged)
+		{
+			this->Camera = Other.Camera;
+			this->FrameBuffer.Resize(Other.Camera.FilmSize);
+		}
+
+		if (Changes & Enums::LightsChanged)
+			this->LightIDs = Other.LightIDs;
+
+		if (Changes & Enums::RenderSettingsChanged)
+			this->RenderSettings = Other.RenderSettings;
+
+		if (Changes & Enums::SceneChanged)
+		{
+			this->VolumeID			= Other.VolumeID;
+			this->LabelVolumeID		= Other.LabelVolumeID;
+			this->ObjectIDs			= Other.ObjectIDs;
+			this->ClippingObjectIDs	= Other.ClippingObjectIDs;
+		}
+
+		if (Changes & Enums::LabelsChanged)
+		{
+			this->Labels		= Other.Labels;
+			this->LabelTable	= this->Labels;
+		}
+
+		this->UpdateShadingVariant();
+		this->UpdateWavefront();
+
+		if (Changes)
+			this->NoIterations = 0;
+	}
+
+	/*
+		Selects the most specialized shading path that is exact for the current transfer functions and shading type
+	*/
+	HOST void UpdateShadingVariant()
+	{
+		this->ShadingVariant = Enums::DiffuseShading;
+
+		switch (this->RenderSettings.Shading.Type)
+		{
+			case Enums::BrdfOnly:
+				break;
+
+			case Enums::PhaseFunctionOnly:
+				this->ShadingVariant |= Enums::PhaseShading;
+				break;
+
+			default:
+				this->ShadingVariant |= Enums::HybridShading;
+				break;
+		}
+
+		if (this->MaterialTable.Specular && !(this->ShadingVariant & Enums::PhaseShading))
+			this->ShadingVariant |= Enums::SpecularShading;
+
+		if (this->MaterialTable.Emissive)
+			this->ShadingVariant |= Enums::EmissiveShading;
+	}
+
+	/*
+		The wavefront queues are sized for one entry per pixel and only allocated while wavefront rendering is enabled
+	*/
+	HOST void UpdateWavefront()
+	{
+		if (this->RenderSettings.Traversal.Wavefront)
+			this->Wavefront.Resize(this->FrameBuffer.Resolution);
+		else
+			this->Wavefront.Free();
+	}
+
+	HOST_DEVICE float GetOpacity(const float& Intensity, const float& GradientMagnitude) const
+	{
+		if (this->Opacity2D.Enabled())
+			return this->Opacity2D.Evaluate(Intensity, GradientMagnitude);
+
+		return this->MaterialTable(Intensity).Opacity;
+	}
+
+	/*
+		Opacity scale of a label, one for labels without an entry in the label table
+	*/
+	HOST_DEVICE float GetLabelOpacity(const int& ID) const
+	{
+		return ID >= 0 && ID < this->LabelTable.GetNoElements() ? this->LabelTable.Data[ID].GetOpacity() : 1.0f;
+	}
+
+	/*
+		Diffuse color scale of a label, white for labels without an entry in the label table
+	*/
+	HOST_DEVICE ColorXYZf GetLabelDiffuse(const int& ID) const
+	{
+		return ID >= 0 && ID < this->LabelTable.GetNoElements() ? this->LabelTable.Data[ID].Diffuse : ColorXYZf(1.0f);
+	}
+
+	HOST_DEVICE float GetMaximumOpacity(const float& Min, const float& Max) const
+	{
+		if (this->Opacity2D.Enabled())
+			return this->Opacity2D.Maximum(Min, Max);
+
+		return this->Opacity1D.Maximum(Min, Max);
+	}
+
+	FrameBuffer					FrameBuffer;
+	BoundingBox					VisibleBoundingBox;
+	Range						PreIntegrationRange;
+	Buffer2D<float>				PreIntegratedOpacity;
+	Buffer3D<Label>				LabelTable;
+	TransferFunctionTable		OpacityTable;
+	MaterialTable				MaterialTable;
+	int							ShadingVariant;
+	Range						ClassificationWindow;
+	Buffer3D<unsigned char>		ClassifiedVoxels;
+	WavefrontQueues				Wavefront;
+	AliasTable					LightDistribution;
+	LightBVH					LightBVH;
+	int							EnvironmentLightID;
+	TransmittanceCache			TransmittanceCache;
 };
 
 }
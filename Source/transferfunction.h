@@ -20,6 +20,7 @@
 
 #include "plf.h"
 #include "color.h"
+#include "range.h"
 
 namespace ExposureRender
 {
@@ -107,11 +108,21 @@ public:
 		this->PLF.AddNode(Node.Position, Node.Value);
 	}
 
+	HOST bool operator == (const ScalarTransferFunction1D& Other) const
+	{
+		return this->PLF == Other.PLF;
+	}
+
 	HOST_DEVICE float Evaluate(const float& Intensity) const
 	{
 		return this->PLF.Evaluate(Intensity);
 	}
 
+	HOST_DEVICE float Maximum(const float& Min, const float& Max) const
+	{
+		return this->PLF.Maximum(Min, Max);
+	}
+
 	PiecewiseLinearFunction<MAX_NO_TF_NODES> PLF;
 };
 
@@ -153,4 +164,332 @@ public:
 	PiecewiseLinearFunction<MAX_NO_TF_NODES> PLF[3];
 };
 
+/*
+	Box in (intensity, gradient magnitude) space that assigns a single value to the voxels inside it
+*/
+class EXPOSURE_RENDER_DLL ScalarBox
+{
+public:
+	HOST ScalarBox(const Vec2f& Min, const Vec2f& Max, const float& Value) :
+		Min(Min),
+		Max(Max),
+		Value(Value)
+	{
+	}
+
+	HOST ScalarBox() :
+		Min(0.0f),
+		Max(0.0f),
+		Value(0.0f)
+	{
+	}
+
+	HOST ScalarBox(const ScalarBox& Other)
+	{
+		*this = Other;
+	}
+
+	HOST ScalarBox& operator = (const ScalarBox& Other)
+	{
+		this->Min	= Other.Min;
+		this->Max	= Other.Max;
+		this->Value	= Other.Value;
+
+		return *this;
+	}
+
+	HOST bool operator == (const ScalarBox& Other) const
+	{
+		return this->Min == Other.Min && this->Max == Other.Max && this->Value == Other.Value;
+	}
+
+	HOST bool Contains(const float& Intensity, const float& GradientMagnitude) const
+	{
+		return Intensity >= this->Min[0] && Intensity <= this->Max[0] && GradientMagnitude >= this->Min[1] && GradientMagnitude <= this->Max[1];
+	}
+
+	Vec2f	Min;
+	Vec2f	Max;
+	float	Value;
+};
+
+class EXPOSURE_RENDER_DLL ColorBox
+{
+public:
+	HOST ColorBox()
+	{
+	}
+
+	HOST ColorBox(const ColorBox& Other)
+	{
+		*this = Other;
+	}
+
+	HOST ColorBox& operator = (const ColorBox& Other)
+	{
+		for (int i = 0; i < 3; i++)
+			this->ScalarBoxes[i] = Other.ScalarBoxes[i];
+
+		return *this;
+	}
+
+	ScalarBox	ScalarBoxes[3];
+};
+
+/*
+	Compact (intensity, gradient magnitude) lookup table of TF2D_NO_SAMPLES^2 cells, values are stored as
+	bytes relative to the largest value in the table and are constant per cell. Lookups outside the table
+	return zero
+*/
+class EXPOSURE_RENDER_DLL Table2D
+{
+public:
+	HOST Table2D() :
+		Scale(0.0f)
+	{
+		memset(this->Values, 0, TF2D_NO_SAMPLES * TF2D_NO_SAMPLES);
+	}
+
+	HOST Table2D(const Table2D& Other)
+	{
+		*this = Other;
+	}
+
+	HOST Table2D& operator = (const Table2D& Other)
+	{
+		this->Ranges[0]	= Other.Ranges[0];
+		this->Ranges[1]	= Other.Ranges[1];
+		this->Scale		= Other.Scale;
+
+		memcpy(this->Values, Other.Values, TF2D_NO_SAMPLES * TF2D_NO_SAMPLES);
+
+		return *this;
+	}
+
+	/*
+		Rasterizes the boxes conservatively, a box covers every cell it overlaps so that boxes narrower
+		than a cell never vanish. Later boxes overwrite earlier ones. The table spans the union of the boxes
+	*/
+	HOST void Bake(const ScalarBox* pBoxes, const int& NoBoxes)
+	{
+		Vec2f Min(FLT_MAX), Max(-FLT_MAX);
+
+		for (int i = 0; i < NoBoxes; i++)
+		{
+			Min = Vec2f(min(Min[0], pBoxes[i].Min[0]), min(Min[1], pBoxes[i].Min[1]));
+			Max = Vec2f(max(Max[0], pBoxes[i].Max[0]), max(Max[1], pBoxes[i].Max[1]));
+		}
+
+		if (NoBoxes <= 0)
+			Min = Max = Vec2f(0.0f);
+
+		this->Ranges[0].Set(Min[0], Max[0]);
+		this->Ranges[1].Set(Min[1], Max[1]);
+
+		float Cells[TF2D_NO_SAMPLES * TF2D_NO_SAMPLES];
+
+		for (int i = 0; i < TF2D_NO_SAMPLES * TF2D_NO_SAMPLES; i++)
+			Cells[i] = 0.0f;
+
+		for (int i = 0; i < NoBoxes; i++)
+		{
+			int CellMin[2], CellMax[2];
+
+			for (int j = 0; j < 2; j++)
+			{
+				const float Scale = this->Ranges[j].Inv * (float)TF2D_NO_SAMPLES;
+
+				CellMin[j] = Clamp((int)floorf((pBoxes[i].Min[j] - this->Ranges[j].Min) * Scale), 0, TF2D_NO_SAMPLES - 1);
+				CellMax[j] = Clamp((int)ceilf((pBoxes[i].Max[j] - this->Ranges[j].Min) * Scale) - 1, CellMin[j], TF2D_NO_SAMPLES - 1);
+			}
+
+			for (int y = CellMin[1]; y <= CellMax[1]; y++)
+			{
+				for (int x = CellMin[0]; x <= CellMax[0]; x++)
+					Cells[y * TF2D_NO_SAMPLES + x] = pBoxes[i].Value;
+			}
+		}
+
+		float Largest = 0.0f;
+
+		for (int i = 0; i < TF2D_NO_SAMPLES * TF2D_NO_SAMPLES; i++)
+			Largest = max(Largest, Cells[i]);
+
+		this->Scale = Largest / 255.0f;
+
+		for (int i = 0; i < TF2D_NO_SAMPLES * TF2D_NO_SAMPLES; i++)
+			this->Values[i] = Largest > 0.0f ? (unsigned char)(Cells[i] / Largest * 255.0f + 0.5f) : 0;
+	}
+
+	HOST_DEVICE float Lookup(const float& Intensity, const float& GradientMagnitude) const
+	{
+		if (Intensity < this->Ranges[0].Min || Intensity > this->Ranges[0].Max || GradientMagnitude < this->Ranges[1].Min || GradientMagnitude > this->Ranges[1].Max)
+			return 0.0f;
+
+		const int X = min((int)(this->Ranges[0].Normalize(Intensity) * (float)TF2D_NO_SAMPLES), TF2D_NO_SAMPLES - 1);
+		const int Y = min((int)(this->Ranges[1].Normalize(GradientMagnitude) * (float)TF2D_NO_SAMPLES), TF2D_NO_SAMPLES - 1);
+
+		return this->Scale * (float)this->Values[Y * TF2D_NO_SAMPLES + X];
+	}
+
+	Range			Ranges[2];
+	float			Scale;
+	unsigned char	Values[TF2D_NO_SAMPLES * TF2D_NO_SAMPLES];
+};
+
+/*
+	Transfer function over intensity and gradient magnitude, defined by a number of boxes and baked
+	into a compact table. Without boxes the function is disabled and the 1D function is used instead
+*/
+class EXPOSURE_RENDER_DLL ScalarTransferFunction2D
+{
+public:
+	HOST ScalarTransferFunction2D() :
+		NoBoxes(0),
+		Table()
+	{
+	}
+
+	HOST ~ScalarTransferFunction2D()
+	{
+	}
+
+	HOST ScalarTransferFunction2D(const ScalarTransferFunction2D& Other)
+	{
+		*this = Other;
+	}
+
+	HOST ScalarTransferFunction2D& operator = (const ScalarTransferFunction2D& Other)
+	{
+		for (int i = 0; i < Other.NoBoxes; i++)
+			this->Boxes[i] = Other.Boxes[i];
+
+		this->NoBoxes	= Other.NoBoxes;
+		this->Table		= Other.Table;
+
+		return *this;
+	}
+
+	HOST void AddBox(const ScalarBox& Box)
+	{
+		if (this->NoBoxes >= MAX_NO_TF2D_BOXES)
+			return;
+
+		this->Boxes[this->NoBoxes++] = Box;
+	}
+
+	HOST bool operator == (const ScalarTransferFunction2D& Other) const
+	{
+		if (this->NoBoxes != Other.NoBoxes)
+			return false;
+
+		for (int i = 0; i < this->NoBoxes; i++)
+		{
+			if (!(this->Boxes[i] == Other.Boxes[i]))
+				return false;
+		}
+
+		return true;
+	}
+
+	HOST void Bake()
+	{
+		this->Table.Bake(this->Boxes, this->NoBoxes);
+	}
+
+	HOST_DEVICE bool Enabled() const
+	{
+		return this->NoBoxes > 0;
+	}
+
+	HOST_DEVICE float Evaluate(const float& Intensity, const float& GradientMagnitude) const
+	{
+		return this->Table.Lookup(Intensity, GradientMagnitude);
+	}
+
+	/*
+		Maximum of the function over an intensity interval, for any gradient magnitude
+	*/
+	HOST_DEVICE float Maximum(const float& Min, const float& Max) const
+	{
+		float Result = 0.0f;
+
+		for (int i = 0; i < this->NoBoxes; i++)
+		{
+			if (this->Boxes[i].Min[0] <= Max && this->Boxes[i].Max[0] >= Min)
+				Result = fmaxf(Result, this->Boxes[i].Value);
+		}
+
+		return Result;
+	}
+
+	ScalarBox	Boxes[MAX_NO_TF2D_BOXES];
+	int			NoBoxes;
+	Table2D		Table;
+};
+
+class EXPOSURE_RENDER_DLL ColorTransferFunction2D
+{
+public:
+	HOST ColorTransferFunction2D() :
+		NoBoxes(0)
+	{
+	}
+
+	HOST ~ColorTransferFunction2D()
+	{
+	}
+
+	HOST ColorTransferFunction2D(const ColorTransferFunction2D& Other)
+	{
+		*this = Other;
+	}
+
+	HOST ColorTransferFunction2D& operator = (const ColorTransferFunction2D& Other)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < Other.NoBoxes; j++)
+				this->Boxes[i][j] = Other.Boxes[i][j];
+
+			this->Tables[i] = Other.Tables[i];
+		}
+
+		this->NoBoxes = Other.NoBoxes;
+
+		return *this;
+	}
+
+	HOST void AddBox(const ColorBox& Box)
+	{
+		if (this->NoBoxes >= MAX_NO_TF2D_BOXES)
+			return;
+
+		for (int i = 0; i < 3; i++)
+			this->Boxes[i][this->NoBoxes] = Box.ScalarBoxes[i];
+
+		this->NoBoxes++;
+	}
+
+	HOST void Bake()
+	{
+		for (int i = 0; i < 3; i++)
+			this->Tables[i].Bake(this->Boxes[i], this->NoBoxes);
+	}
+
+	HOST_DEVICE bool Enabled() const
+	{
+		return this->NoBoxes > 0;
+	}
+
+	HOST_DEVICE ColorXYZf Evaluate(const float& Intensity, const float& GradientMagnitude) const
+	{
+		return ColorXYZf(this->Tables[0].Lookup(Intensity, GradientMagnitude), this->Tables[1].Lookup(Intensity, GradientMagnitude), this->Tables[2].Lookup(Intensity, GradientMagnitude));
+	}
+
+	ScalarBox	Boxes[3][MAX_NO_TF2D_BOXES];
+	int			NoBoxes;
+	Table2D		Tables[3];
+};
+
 }
@@ -0,0 +1,123 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "buffer3d.h"
+#include "transferfunction.h"
+
+namespace ExposureRender
+{
+
+/*
+	1D transfer function sampled at TF_NO_SAMPLES evenly spaced intensities over its node range. The samples live
+	in a device buffer owned by the tracer, so the bindable function only carries its nodes. Outside the node range
+	the function is constant, so clamping the lookup intensity reproduces Evaluate()
+*/
+class EXPOSURE_RENDER_DLL TransferFunctionTable
+{
+public:
+	HOST TransferFunctionTable() :
+		Range(),
+		Samples(Enums::Device, "Device Transfer Function Samples")
+	{
+	}
+
+	HOST virtual ~TransferFunctionTable(void)
+	{
+	}
+
+	HOST TransferFunctionTable(const TransferFunctionTable& Other) :
+		Range(),
+		Samples(Enums::Device, "Device Transfer Function Samples")
+	{
+		*this = Other;
+	}
+
+	HOST TransferFunctionTable& TransferFunctionTable::operator = (const TransferFunctionTable& Other)
+	{
+		this->Range		= Other.Range;
+		this->Samples	= Other.Samples;
+
+		return *this;
+	}
+
+	HOST void Bake(const ScalarTransferFunction1D& Function)
+	{
+		this->Range = Function.PLF.GetNodeRange();
+
+		Buffer3D<float> HostSamples(Enums::Host, "Host Transfer Function Samples");
+
+		HostSamples.Resize(Vec3i(TF_NO_SAMPLES, 1, 1));
+
+		for (int i = 0; i < TF_NO_SAMPLES; i++)
+			HostSamples[i] = Function.Evaluate(this->Range.Min + ((float)i / (float)(TF_NO_SAMPLES - 1)) * this->Range.Extent);
+
+		this->Samples.Set(Enums::Host, HostSamples.Resolution, HostSamples.Data);
+	}
+
+	HOST_DEVICE float Lookup(const float& Intensity) const
+	{
+		const float U	= this->Range.Normalize(Intensity) * (float)(TF_NO_SAMPLES - 1);
+		const int ID	= min((int)U, TF_NO_SAMPLES - 2);
+
+		return this->Samples.Data[ID] + (U - (float)ID) * (this->Samples.Data[ID + 1] - this->Samples.Data[ID]);
+	}
+
+	/*
+		Exact integral of the table over [A, B], the table is linear between samples and constant outside its range
+	*/
+	HOST_DEVICE float Integrate(const float& A, const float& B) const
+	{
+		const float Lo = fminf(A, B);
+		const float Hi = fmaxf(A, B);
+
+		float Result = 0.0f;
+
+		Result += fmaxf(fminf(Hi, this->Range.Min) - Lo, 0.0f) * this->Samples.Data[0];
+		Result += fmaxf(Hi - fmaxf(Lo, this->Range.Max), 0.0f) * this->Samples.Data[TF_NO_SAMPLES - 1];
+
+		if (this->Range.Extent <= 0.0f || Hi <= this->Range.Min || Lo >= this->Range.Max)
+			return Result;
+
+		const float Scale	= (float)(TF_NO_SAMPLES - 1);
+		const float U[2]	= { this->Range.Normalize(Lo) * Scale, this->Range.Normalize(Hi) * Scale };
+		const float DeltaX	= this->Range.Extent / Scale;
+
+		float U0 = U[0];
+
+		while (U0 < U[1])
+		{
+			const float U1 = fminf(floorf(U0) + 1.0f, U[1]);
+
+			const float V0 = this->Lookup(this->Range.Min + U0 * DeltaX);
+			const float V1 = this->Lookup(this->Range.Min + U1 * DeltaX);
+
+			Result += 0.5f * (V0 + V1) * (U1 - U0) * DeltaX;
+
+			U0 = U1;
+		}
+
+		return Result;
+	}
+
+	ExposureRender::Range	Range;
+	Buffer3D<float>			Samples;
+};
+
+}
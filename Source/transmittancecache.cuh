@@ -0,0 +1,83 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "macros.cuh"
+#include "raymarching.h"
+
+namespace ExposureRender
+{
+
+/*
+	One thread per cache voxel, marches the extinction between the voxel centre and LightP
+*/
+KERNEL void KrnlComputeTransmittance(float* pTransmittance, Vec3i Resolution, Vec3f MinP, Vec3f Spacing, Vec3f LightP)
+{
+	KERNEL_3D(Resolution[0], Resolution[1], Resolution[2])
+
+	const Vec3f P = MinP + Vec3f((float)IDx + 0.5f, (float)IDy + 0.5f, (float)IDz + 0.5f) * Spacing;
+
+	const Vec3f W = Normalize(LightP - P);
+
+	pTransmittance[IDk] = VolumeTransmittance(Ray(P, W, 0.0f, min((LightP - P).Length(), gpTracer->RenderSettings.Traversal.MaxShadowDistance)));
+}
+
+/*
+	Fills the transmittance cache of the tracer for the lights in pLightIDs, centred at pLightPositions. The
+	cache is laid over the visible bounding box at a fraction of the volume resolution. The kernels march
+	the tracer through gpTracer, so the caller synchronizes it to the device first
+*/
+void ComputeTransmittanceCache(Tracer& Tracer, const Volume& Volume, const int* pLightIDs, const Vec3f* pLightPositions, const int& NoLights)
+{
+	Tracer.TransmittanceCache.Free();
+
+	if (NoLights <= 0)
+		return;
+
+	const Vec3i Resolution(max(Volume.Resolution[0] / TRANSMITTANCE_CACHE_REDUCTION, 1), max(Volume.Resolution[1] / TRANSMITTANCE_CACHE_REDUCTION, 1), max(Volume.Resolution[2] / TRANSMITTANCE_CACHE_REDUCTION, 1));
+
+	DebugLog("%s, %d lights, %d x %d x %d", __FUNCTION__, NoLights, Resolution[0], Resolution[1], Resolution[2]);
+
+	const Vec3f MinP	= Tracer.VisibleBoundingBox.MinP;
+	const Vec3f MaxP	= Tracer.VisibleBoundingBox.MaxP;
+	const Vec3f Spacing	= (MaxP - MinP) / Vec3f((float)Resolution[0], (float)Resolution[1], (float)Resolution[2]);
+
+	const int NoVoxels = Resolution[0] * Resolution[1] * Resolution[2];
+
+	Tracer.TransmittanceCache.Resize(Resolution, NoLights, MinP, MaxP);
+
+	for (int i = 0; i < NoLights; i++)
+	{
+		LAUNCH_DIMENSIONS(Resolution[0], Resolution[1], Resolution[2], 8, 8, 4)
+		LAUNCH_CUDA_KERNEL((KrnlComputeTransmittance<<<GridDim, BlockDim>>>(Tracer.TransmittanceCache.Transmittance.Data + i * NoVoxels, Resolution, MinP, Spacing, pLightPositions[i])));
+	}
+
+	for (int i = 0; i < NoLights; i++)
+	{
+		Tracer.TransmittanceCache.LightIDs[i]		= pLightIDs[i];
+		Tracer.TransmittanceCache.LightPositions[i]	= pLightPositions[i];
+	}
+
+	Tracer.TransmittanceCache.DensityScale		= Tracer.RenderSettings.Shading.DensityScale;
+	Tracer.TransmittanceCache.StepFactorShadow	= Tracer.RenderSettings.Traversal.StepFactorShadow;
+	Tracer.TransmittanceCache.MaxShadowDistance	= Tracer.RenderSettings.Traversal.MaxShadowDistance;
+}
+
+}
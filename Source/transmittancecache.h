@@ -0,0 +1,193 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "buffer3d.h"
+
+namespace ExposureRender
+{
+
+/*
+	Transmittance from the voxels of a reduced resolution grid over the visible bounding box towards
+	the centre of up to MAX_NO_TRANSMITTANCE_CACHES lights. The grids of the cached lights are stacked
+	along the z-axis of a single buffer
+*/
+class EXPOSURE_RENDER_DLL TransmittanceCache
+{
+public:
+	HOST TransmittanceCache() :
+		NoLights(0),
+		Resolution(0),
+		MinP(0.0f),
+		MaxP(0.0f),
+		DensityScale(0.0f),
+		StepFactorShadow(0.0f),
+		MaxShadowDistance(0.0f),
+		Transmittance(Enums::Device, "Device Transmittance Cache")
+	{
+		for (int i = 0; i < MAX_NO_TRANSMITTANCE_CACHES; i++)
+			this->LightIDs[i] = -1;
+	}
+
+	HOST virtual ~TransmittanceCache(void)
+	{
+	}
+
+	HOST TransmittanceCache(const TransmittanceCache& Other) :
+		NoLights(0),
+		Resolution(0),
+		MinP(0.0f),
+		MaxP(0.0f),
+		DensityScale(0.0f),
+		StepFactorShadow(0.0f),
+		MaxShadowDistance(0.0f),
+		Transmittance(Enums::Device, "Device Transmittance Cache")
+	{
+		*this = Other;
+	}
+
+	HOST TransmittanceCache& TransmittanceCache::operator = (const TransmittanceCache& Other)
+	{
+		this->NoLights		= Other.NoLights;
+		this->Resolution	= Other.Resolution;
+		this->MinP			= Other.MinP;
+		this->MaxP				= Other.MaxP;
+		this->DensityScale		= Other.DensityScale;
+		this->StepFactorShadow	= Other.StepFactorShadow;
+		this->MaxShadowDistance	= Other.MaxShadowDistance;
+		this->Transmittance		= Other.Transmittance;
+
+		for (int i = 0; i < MAX_NO_TRANSMITTANCE_CACHES; i++)
+		{
+			this->LightIDs[i]		= Other.LightIDs[i];
+			this->LightPositions[i]	= Other.LightPositions[i];
+		}
+
+		return *this;
+	}
+
+	HOST void Resize(const Vec3i& Resolution, const int& NoLights, const Vec3f& MinP, const Vec3f& MaxP)
+	{
+		this->NoLights		= NoLights;
+		this->Resolution	= Resolution;
+		this->MinP			= MinP;
+		this->MaxP			= MaxP;
+
+		this->Transmittance.Resize(Vec3i(Resolution[0], Resolution[1], Resolution[2] * NoLights));
+	}
+
+	/*
+		Whether the cache was computed for these lights and these settings, only then can a rebuild be skipped
+		when the volume and its classification did not change
+	*/
+	HOST bool Matches(const int* pLightIDs, const Vec3f* pLightPositions, const int& NoLights, const float& DensityScale, const float& StepFactorShadow, const float& MaxShadowDistance) const
+	{
+		if (NoLights != this->NoLights)
+			return false;
+
+		if (NoLights <= 0)
+			return true;
+
+		if (DensityScale != this->DensityScale || StepFactorShadow != this->StepFactorShadow || MaxShadowDistance != this->MaxShadowDistance)
+			return false;
+
+		for (int i = 0; i < NoLights; i++)
+		{
+			if (pLightIDs[i] != this->LightIDs[i] || !(pLightPositions[i] == this->LightPositions[i]))
+				return false;
+		}
+
+		return true;
+	}
+
+	HOST void Free(void)
+	{
+		this->NoLights		= 0;
+		this->Resolution	= Vec3i(0);
+
+		for (int i = 0; i < MAX_NO_TRANSMITTANCE_CACHES; i++)
+			this->LightIDs[i] = -1;
+
+		this->Transmittance.Free();
+	}
+
+	/*
+		Trilinearly interpolated transmittance from P towards the light with LightID, false when the
+		light is not cached or P lies outside the cache
+	*/
+	HOST_DEVICE bool Lookup(const int& LightID, const Vec3f& P, float& T) const
+	{
+		int Slot = -1;
+
+		for (int i = 0; i < this->NoLights; i++)
+		{
+			if (this->LightIDs[i] == LightID)
+				Slot = i;
+		}
+
+		if (Slot < 0)
+			return false;
+
+		if (P[0] < this->MinP[0] || P[1] < this->MinP[1] || P[2] < this->MinP[2] || P[0] > this->MaxP[0] || P[1] > this->MaxP[1] || P[2] > this->MaxP[2])
+			return false;
+
+		Vec3f XYZ;
+
+		for (int i = 0; i < 3; i++)
+			XYZ[i] = Clamp((P[i] - this->MinP[i]) / (this->MaxP[i] - this->MinP[i]) * (float)this->Resolution[i] - 0.5f, 0.0f, (float)(this->Resolution[i] - 1));
+
+		const int X = (int)XYZ[0];
+		const int Y = (int)XYZ[1];
+		const int Z = (int)XYZ[2];
+
+		const float DX = XYZ[0] - X;
+		const float DY = XYZ[1] - Y;
+		const float DZ = XYZ[2] - Z;
+
+		const int X1 = min(X + 1, this->Resolution[0] - 1);
+		const int Y1 = min(Y + 1, this->Resolution[1] - 1);
+		const int Z0 = Slot * this->Resolution[2] + Z;
+		const int Z1 = Slot * this->Resolution[2] + min(Z + 1, this->Resolution[2] - 1);
+
+		const float T00 = Lerp(DX, this->Transmittance(X, Y, Z0), this->Transmittance(X1, Y, Z0));
+		const float T10 = Lerp(DX, this->Transmittance(X, Y1, Z0), this->Transmittance(X1, Y1, Z0));
+		const float T01 = Lerp(DX, this->Transmittance(X, Y, Z1), this->Transmittance(X1, Y, Z1));
+		const float T11 = Lerp(DX, this->Transmittance(X, Y1, Z1), this->Transmittance(X1, Y1, Z1));
+		const float T0	= Lerp(DY, T00, T10);
+		const float T1	= Lerp(DY, T01, T11);
+
+		T = Lerp(DZ, T0, T1);
+
+		return true;
+	}
+
+	int					NoLights;
+	int					LightIDs[MAX_NO_TRANSMITTANCE_CACHES];
+	Vec3f				LightPositions[MAX_NO_TRANSMITTANCE_CACHES];
+	Vec3i				Resolution;
+	Vec3f				MinP;
+	Vec3f				MaxP;
+	float				DensityScale;
+	float				StepFactorShadow;
+	float				MaxShadowDistance;
+	Buffer3D<float>		Transmittance;
+};
+
+}
@@ -43,9 +43,10 @@ HOST_DEVICE_NI bool Intersect(const Ray& R, CRNG& RNG)
 	return false;
 }
 
+template<int Variant>
 HOST_DEVICE_NI bool Visible(const Vec3f& P1, const Vec3f& P2, CRNG& RNG)
 {
-	if (!gpTracer->RenderSettings.Traversal.Shadows)
+	if (!(Variant & Enums::ShadowsVariant))
 		return true;
 
 	Vec3f W = Normalize(P2 - P1);
@@ -55,7 +56,33 @@ HOST_DEVICE_NI bool Visible(const Vec3f& P1, const Vec3f& P2, CRNG& RNG)
 	return !Intersect(R, RNG);
 }
 
-HOST_DEVICE_NI ColorXYZf EstimateDirectLight(const Light& Light, LightingSample& LS, ScatterEvent& SE, CRNG& RNG, Shader& Shader)
+/*
+	Looks up the volumetric shadowing of P1 by Light in the transmittance cache of the tracer, so that
+	only lights and objects between P1 and P2 are traced. False when there is no cache entry for P1
+*/
+template<int Variant>
+HOST_DEVICE_NI bool CachedTransmittance(const Light& Light, const Vec3f& P1, const Vec3f& P2, float& T)
+{
+	if (!(Variant & Enums::ShadowsVariant) || !gpTracer->TransmittanceCache.Lookup(Light.ID, P1, T))
+		return false;
+
+	Vec3f W = Normalize(P2 - P1);
+
+	const Ray R(P1 + W * RAY_EPS, W, 0.0f, min((P2 - P1).Length() - RAY_EPS_2, gpTracer->RenderSettings.Traversal.MaxShadowDistance));
+
+	if (IntersectsLight(R) || IntersectsObject(R))
+		T = 0.0f;
+
+	return true;
+}
+
+/*
+	Direct light from Light, which was selected with probability SelectionPdf. Cached lights are attenuated
+	by their transmittance cache. Otherwise, in the wavefront variant the visibility test is deferred, the
+	unoccluded contribution is stored in Shadow and traced by the shadow march stage instead
+*/
+template<int Variant, class T>
+HOST_DEVICE_NI ColorXYZf EstimateDirectLight(const Light& Light, const float& SelectionPdf, LightingSample& LS, ScatterEvent& SE, CRNG& RNG, T& Shader, ShadowRay& Shadow)
 {
 	Vec3f Wi;
 	
@@ -63,22 +90,26 @@ HOST_DEVICE_NI ColorXYZf EstimateDirectLight(const Light& Light, LightingSample&
 
 	SurfaceSample SS;
 
-	SampleLight(Light, LS.LightSample, SS, SE, Wi, Li);
+	float LightPdf = 0.0f, Transmittance = 1.0f;
+
+	SampleLight(Light, LS.LightSample, SS, SE, Wi, Li, LightPdf);
 	
 	ColorXYZf F = Shader.F(SE.Wo, Wi);
 	
 	float BsdfPdf = Shader.Pdf(SE.Wo, Wi);
 
-	if (!Li.IsBlack() && !F.IsBlack() && BsdfPdf > 0.0f && Visible(SE.P, SS.P, RNG))
+	if (!Li.IsBlack() && !F.IsBlack() && BsdfPdf > 0.0f && LightPdf > 0.0f)
 	{
-		const float LightPdf = DistanceSquared(SE.P, SS.P) / (AbsDot(SS.N, -Wi) * Light.Shape.Area);
-
 		const float Weight = PowerHeuristic(1, LightPdf, 1, BsdfPdf);
 
-		if (Shader.Type == Enums::Brdf)
-			Ld += F * Li * (AbsDot(Wi, SE.N) * Weight / LightPdf);
-		else
-			Ld += F * Li / LightPdf;
+		const ColorXYZf L = Shader.Type == Enums::Brdf ? F * Li * (AbsDot(Wi, SE.N) * Weight / (SelectionPdf * LightPdf)) : F * Li / (SelectionPdf * LightPdf);
+
+		if (CachedTransmittance<Variant>(Light, SE.P, SS.P, Transmittance))
+			Ld += L * Transmittance;
+		else if (Variant & Enums::WavefrontVariant)
+			Shadow = ShadowRay(SE.P, SS.P, L);
+		else if (Visible<Variant>(SE.P, SS.P, RNG))
+			Ld += L;
 	}
 
 	return Ld;
@@ -97,46 +128,118 @@ HOST_DEVICE_NI ColorXYZf EstimateDirectLight(const Light& Light, LightingSample&
 
 	Li = SE2.Le;
 
-	if (!Li.IsBlack() && Visible(SE.P, SE2.P, RNG))
+	if (!Li.IsBlack() && Visible<Variant>(SE.P, SE2.P, RNG))
 	{
 		const float LightPdf = DistanceSquared(SE.P, SE2.P) / (AbsDot(SE.N, -Wi) * Light.Shape.Area);
 
 		const float Weight = PowerHeuristic(1, BsdfPdf, 1, LightPdf);
 
 		if (Shader.Type == Enums::Brdf)
-			Ld += F * Li * (AbsDot(Wi, SE.N) * Weight / BsdfPdf);
+			Ld += F * Li * (AbsDot(Wi, SE.N) * Weight / (SelectionPdf * BsdfPdf));
 		else
-			Ld += F * Li / BsdfPdf;
+			Ld += F * Li / (SelectionPdf * BsdfPdf);
 	}
 	
 	return Ld;
 }
 
-HOST_DEVICE_NI ColorXYZf UniformSampleOneLight(ScatterEvent& SE, CRNG& RNG, LightingSample& LS)
+/*
+	Probability of shading a volume scatter event with the surface shader instead of the phase function,
+	driven by the normalized gradient magnitude from the cached gradient magnitude volume
+*/
+HOST_DEVICE_NI float GetSurfaceProbability(const Vec3f& P, const float& Intensity, const Material& Material)
+{
+	const float GM	= GetGradientMagnitude(gpTracer->VolumeID, P);
+	const float NGM	= gpVolumes[gpTracer->VolumeID].GradientMagnitudeRange.Normalize(GM);
+
+	switch (gpTracer->RenderSettings.Shading.Type)
+	{
+		case Enums::Hybrid:
+		{
+			const float Sensitivity	= 25.0f;
+			const float GF			= gpTracer->RenderSettings.Shading.GradientFactor;
+			const float Exponent	= Sensitivity * GF * GF * GF * NGM;
+			const float Opacity		= gpTracer->Opacity2D.Enabled() ? gpTracer->Opacity2D.Evaluate(Intensity, GM) : Material.Opacity;
+			const float Surface		= 1.0f - Exp(-Exponent, gpTracer->RenderSettings.Shading.MathAccuracy);
+
+			return gpTracer->RenderSettings.Shading.OpacityModulated ? Opacity * Surface : Surface;
+		}
+
+		case Enums::Modulation:
+			return 1.0f - (1.0f - NGM) * (1.0f - NGM);
+
+		case Enums::Threshold:
+			return NGM > gpTracer->RenderSettings.Shading.GradientThreshold ? 1.0f : 0.0f;
+
+		case Enums::GradientMagnitude:
+			return NGM;
+	}
+
+	return 1.0f;
+}
+
+/*
+	Direct lighting of a volume scatter event with the shader selected by the shading variant. Variant
+	is a compile time constant, so each instantiation only contains the shaders it can pick from
+*/
+template<int Variant>
+HOST_DEVICE_NI ColorXYZf EstimateDirectLightVolume(const Light& Light, const float& SelectionPdf, LightingSample& LS, ScatterEvent& SE, CRNG& RNG, const float& Intensity, const Material& Material, const ColorXYZf& Diffuse, ShadowRay& Shadow)
+{
+	if ((Variant & Enums::PhaseShading) || ((Variant & Enums::HybridShading) && RNG.Get1() >= GetSurfaceProbability(SE.P, Intensity, Material)))
+	{
+		PhaseShader Shader(Diffuse);
+		return EstimateDirectLight<Variant>(Light, SelectionPdf, LS, SE, RNG, Shader, Shadow);
+	}
+
+	if (Variant & Enums::SpecularShading)
+	{
+		SurfaceShader Shader(SE.N, SE.Wo, Diffuse, Material.Specular, 15.0f, Material.Exponent, gpTracer->RenderSettings.Shading.MathAccuracy);
+		return EstimateDirectLight<Variant>(Light, SelectionPdf, LS, SE, RNG, Shader, Shadow);
+	}
+
+	DiffuseShader Shader(SE.N, Diffuse, Material.Exponent, gpTracer->RenderSettings.Shading.MathAccuracy);
+	return EstimateDirectLight<Variant>(Light, SelectionPdf, LS, SE, RNG, Shader, Shadow);
+}
+
+/*
+	Samples one light proportional to its emitted power from the alias table of the tracer
+*/
+template<int Variant>
+HOST_DEVICE_NI ColorXYZf SampleOneLight(ScatterEvent& SE, CRNG& RNG, LightingSample& LS, ShadowRay& Shadow)
 {
 	ColorXYZf Ld;
 
 	const float Intensity = GetIntensity(gpTracer->VolumeID, SE.P);
 
-	Ld += gpTracer->Emission1D.Evaluate(Intensity);
+	const Material& Material = gpTracer->MaterialTable(Intensity);
 
-	if (gpTracer->LightIDs.Count <= 0)
+	if (Variant & Enums::EmissiveShading)
+		Ld += Material.Emission;
+
+	if (gpTracer->LightDistribution.Count <= 0)
 		return Ld;
 
-	const int LightID = gpTracer->LightIDs[(int)floorf(LS.LightNum * gpTracer->LightIDs.Count)];
+	float SelectionPdf = 0.0f;
+
+	const int LightID = gpTracer->LightIDs[gpTracer->LightDistribution.Sample(LS.LightNum, SelectionPdf)];
 
-	if (LightID < 0)
+	if (LightID < 0 || SelectionPdf <= 0.0f)
 		return Ld;
 
 	const Light& Light = gpLights[LightID];
 	
-	Shader Shader;
-	
 	switch (SE.Type)
 	{
 		case Enums::Volume:	
-			Shader = ExposureRender::Shader(Enums::Brdf, SE.N, SE.Wo, gpTracer->Diffuse1D.Evaluate(Intensity), gpTracer->Specular1D.Evaluate(Intensity), 15.0f, GlossinessExponent(gpTracer->Glossiness1D.Evaluate(Intensity)));
+		{
+			ColorXYZf Diffuse = gpTracer->Diffuse2D.Enabled() ? gpTracer->Diffuse2D.Evaluate(Intensity, GetGradientMagnitude(gpTracer->VolumeID, SE.P)) : Material.Diffuse;
+
+			if (gpTracer->LabelVolumeID >= 0)
+				Diffuse *= gpTracer->GetLabelDiffuse(GetLabelID(gpTracer->LabelVolumeID, SE.P));
+
+			Ld += EstimateDirectLightVolume<Variant>(Light, SelectionPdf, LS, SE, RNG, Intensity, Material, Diffuse, Shadow);
 			break;
+		}
 
 		case Enums::Object:
 		{
@@ -144,15 +247,14 @@ HOST_DEVICE_NI ColorXYZf UniformSampleOneLight(ScatterEvent& SE, CRNG& RNG, Ligh
 			const ColorXYZf Specular	= EvaluateTexture(gpObjects[SE.ObjectID].SpecularTextureID, SE.UV);
 			const ColorXYZf Glossiness	= EvaluateTexture(gpObjects[SE.ObjectID].GlossinessTextureID, SE.UV);
 
-			Shader = ExposureRender::Shader(Enums::Brdf, SE.N, SE.Wo, Diffuse, Specular, 15.0f, GlossinessExponent(Glossiness.Y()));
+			SurfaceShader Shader(SE.N, SE.Wo, Diffuse, Specular, 15.0f, GlossinessExponent(Glossiness.Y()), gpTracer->RenderSettings.Shading.MathAccuracy);
+
+			Ld += EstimateDirectLight<Variant>(Light, SelectionPdf, LS, SE, RNG, Shader, Shadow);
 			break;
 		}
 	}
-	/**/
-
-	Ld += EstimateDirectLight(Light, LS, SE, RNG, Shader);
 
-	return (float)gpTracer->LightIDs.Count * Ld;
+	return Ld;
 }
 
 }
\ No newline at end of file
@@ -27,7 +27,9 @@ namespace ExposureRender
 
 HOST_DEVICE float GlossinessExponent(const float& Glossiness)
 {
-	return 1000000.0f * powf(Glossiness, 7);
+	const float G2 = Glossiness * Glossiness;
+
+	return 1000000.0f * G2 * G2 * G2 * Glossiness;
 }
 
 HOST_DEVICE_NI Vec3f ToVec3f(float3 V)
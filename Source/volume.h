@@ -20,6 +20,8 @@
 
 #include "ervolume.h"
 #include "boundingbox.h"
+#include "range.h"
+#include "sparsegrid.h"
 
 namespace ExposureRender
 {
@@ -37,9 +39,18 @@ public:
 		Size(1.0f),
 		InvSize(1.0f),
 		MinStep(1.0f),
-		Voxels(Enums::Device, "Device Voxels")
+		Resolution(0),
+		IntensityRange(),
+		GradientMagnitudeRange(),
+		Voxels(Enums::Device, "Device Voxels"),
+		GradientMagnitudes(Enums::Device, "Device Gradient Magnitudes"),
+		CacheGradients(false),
+		Gradients(Enums::Device, "Device Gradients"),
+		Macrocells(Enums::Device, "Device Macrocells"),
+		SparseGrid()
 	{
 		DebugLog(__FUNCTION__);
+		memset(this->Histogram, 0, NO_HISTOGRAM_BINS * sizeof(int));
 	}
 
 	HOST virtual ~Volume(void)
@@ -57,7 +68,15 @@ public:
 		Size(1.0f),
 		InvSize(1.0f),
 		MinStep(1.0f),
-		Voxels(Enums::Device, "Device Voxels")
+		Resolution(0),
+		IntensityRange(),
+		GradientMagnitudeRange(),
+		Voxels(Enums::Device, "Device Voxels"),
+		GradientMagnitudes(Enums::Device, "Device Gradient Magnitudes"),
+		CacheGradients(false),
+		Gradients(Enums::Device, "Device Gradients"),
+		Macrocells(Enums::Device, "Device Macrocells"),
+		SparseGrid()
 	{
 		DebugLog(__FUNCTION__);
 		*this = Other;
@@ -73,9 +92,19 @@ public:
 		Size(1.0f),
 		InvSize(1.0f),
 		MinStep(1.0f),
-		Voxels(Enums::Device, "Device Voxels")
+		Resolution(0),
+		IntensityRange(),
+		GradientMagnitudeRange(),
+		Voxels(Enums::Device, "Device Voxels"),
+		GradientMagnitudes(Enums::Device, "Device Gradient Magnitudes"),
+		CacheGradients(false),
+		Gradients(Enums::Device, "Device Gradients"),
+		Macrocells(Enums::Device, "Device Macrocells"),
+		SparseGrid()
 	{
 		DebugLog(__FUNCTION__);
+		memset(this->Histogram, 0, NO_HISTOGRAM_BINS * sizeof(int));
+
 		*this = Other;
 	}
 
@@ -92,7 +121,19 @@ public:
 		this->Size				= Other.Size;
 		this->InvSize			= Other.InvSize;
 		this->MinStep			= Other.MinStep;
-		this->Voxels			= Other.Voxels;
+		this->Resolution		= Other.Resolution;
+		this->IntensityRange			= Other.IntensityRange;
+		this->GradientMagnitudeRange	= Other.GradientMagnitudeRange;
+
+		for (int i = 0; i < NO_HISTOGRAM_BINS; i++)
+			this->Histogram[i] = Other.Histogram[i];
+
+		this->Voxels				= Other.Voxels;
+		this->GradientMagnitudes	= Other.GradientMagnitudes;
+		this->CacheGradients		= Other.CacheGradients;
+		this->Gradients				= Other.Gradients;
+		this->Macrocells			= Other.Macrocells;
+		this->SparseGrid			= Other.SparseGrid;
 
 		return *this;
 	}
@@ -101,19 +142,41 @@ public:
 	{
 		DebugLog(__FUNCTION__);
 
-		this->Voxels = Other.Voxels;
+		// Either representation is rebuilt from the host voxels when switching, even if they are not dirty
+		if (Other.Sparse)
+		{
+			if (Other.Voxels.Dirty || !this->SparseGrid.Enabled)
+			{
+				this->SparseGrid.Build(Other.Voxels, Other.Background);
+				this->Voxels.Free();
+
+				Other.Voxels.Dirty = false;
+			}
+		}
+		else
+		{
+			this->SparseGrid.Free();
+
+			if (this->Voxels.Data == NULL && !Other.Voxels.Dirty)
+				this->Voxels.Set(Other.Voxels.MemoryType, Other.Voxels.Resolution, Other.Voxels.Data);
+			else
+				this->Voxels = Other.Voxels;
+		}
+
+		this->Resolution		= Other.Voxels.Resolution;
+		this->CacheGradients	= Other.CacheGradients;
 
-		float Scale = 0.0f;
+		float Scale = 1.0f;
 
 		if (Other.NormalizeSize)
 		{
-			const Vec3f PhysicalSize = Vec3f((float)this->Voxels.Resolution[0], (float)this->Voxels.Resolution[1], (float)this->Voxels.Resolution[2]) * Other.Spacing;
+			const Vec3f PhysicalSize = Vec3f((float)this->Resolution[0], (float)this->Resolution[1], (float)this->Resolution[2]) * Other.Spacing;
 			Scale = 1.0f / max(PhysicalSize[0], max(PhysicalSize[1], PhysicalSize[2]));
 		}
 
 		this->Spacing		= Scale * Other.Spacing;
 		this->InvSpacing	= 1.0f / this->Spacing;
-		this->Size			= Vec3f((float)this->Voxels.Resolution[0] * this->Spacing[0], (float)this->Voxels.Resolution[1] *this->Spacing[1], (float)this->Voxels.Resolution[2] * this->Spacing[2]);
+		this->Size			= Vec3f((float)this->Resolution[0] * this->Spacing[0], (float)this->Resolution[1] *this->Spacing[1], (float)this->Resolution[2] * this->Spacing[2]);
 		this->InvSize		= 1.0f / this->Size;
 
 		this->BoundingBox.SetMinP(-0.5 * Size);
@@ -128,15 +191,110 @@ public:
 		return *this;
 	}
 
+	/*
+		Takes over the geometry of another volume and allocates voxels of the same resolution,
+		without copying them. Used to stage a timepoint of a time series before uploading it
+	*/
+	HOST void Reshape(const Volume& Other)
+	{
+		DebugLog(__FUNCTION__);
+
+		this->BoundingBox		= Other.BoundingBox;
+		this->GradientDeltaX 	= Other.GradientDeltaX;
+		this->GradientDeltaY 	= Other.GradientDeltaY;
+		this->GradientDeltaZ 	= Other.GradientDeltaZ;
+		this->Spacing			= Other.Spacing;
+		this->InvSpacing		= Other.InvSpacing;
+		this->Size				= Other.Size;
+		this->InvSize			= Other.InvSize;
+		this->MinStep			= Other.MinStep;
+		this->Resolution		= Other.Resolution;
+		this->CacheGradients	= Other.CacheGradients;
+
+		this->Voxels.Resize(Other.Voxels.Resolution);
+	}
+
 	HOST_DEVICE unsigned short operator()(const Vec3f& XYZ = Vec3f(0.0f)) const
 	{
 		const Vec3f Offset = XYZ - this->BoundingBox.MinP;
 		
-		const Vec3f LocalXYZ = Offset * this->InvSize * Vec3f(this->Voxels.Resolution[0], this->Voxels.Resolution[1], this->Voxels.Resolution[2]);
+		const Vec3f LocalXYZ = Offset * this->InvSize * Vec3f(this->Resolution[0], this->Resolution[1], this->Resolution[2]);
+
+		if (this->SparseGrid.Enabled)
+			return this->SparseGrid(LocalXYZ);
 
 		return this->Voxels(LocalXYZ);
 	}
 
+	HOST_DEVICE unsigned short GetVoxel(const int& X, const int& Y, const int& Z) const
+	{
+		if (this->SparseGrid.Enabled)
+			return this->SparseGrid(X, Y, Z);
+
+		return this->Voxels(X, Y, Z);
+	}
+
+	/*
+		Gradient magnitude from the cached gradient magnitude volume, which is quantized over the gradient magnitude range
+	*/
+	HOST_DEVICE float GetGradientMagnitude(const Vec3f& XYZ) const
+	{
+		return this->GradientMagnitudeRange.Min + (float)this->GradientMagnitudes(this->GetLocalCoordinate(XYZ)) * this->GradientMagnitudeRange.Extent / 65535.0f;
+	}
+
+	/*
+		Gradient from the cached gradient volume, the decoded voxel gradients are interpolated trilinearly
+	*/
+	HOST_DEVICE Vec3f GetGradient(const Vec3f& XYZ) const
+	{
+		const Vec3f LocalXYZ = this->GetLocalCoordinate(XYZ);
+
+		const int vx = (int)floorf(LocalXYZ[0]);
+		const int vy = (int)floorf(LocalXYZ[1]);
+		const int vz = (int)floorf(LocalXYZ[2]);
+
+		const float dx = LocalXYZ[0] - vx;
+		const float dy = LocalXYZ[1] - vy;
+		const float dz = LocalXYZ[2] - vz;
+
+		const Vec3f d00 = Lerp(this->DecodeGradient(vx, vy, vz), this->DecodeGradient(vx+1, vy, vz), dx);
+		const Vec3f d10 = Lerp(this->DecodeGradient(vx, vy+1, vz), this->DecodeGradient(vx+1, vy+1, vz), dx);
+		const Vec3f d01 = Lerp(this->DecodeGradient(vx, vy, vz+1), this->DecodeGradient(vx+1, vy, vz+1), dx);
+		const Vec3f d11 = Lerp(this->DecodeGradient(vx, vy+1, vz+1), this->DecodeGradient(vx+1, vy+1, vz+1), dx);
+		const Vec3f d0	= Lerp(d00, d10, dy);
+		const Vec3f d1 	= Lerp(d01, d11, dy);
+
+		return Lerp(d0, d1, dz);
+	}
+
+	/*
+		Unpacks the octahedral normal and 8 bit magnitude of a cached voxel gradient
+	*/
+	HOST_DEVICE Vec3f DecodeGradient(const int& X, const int& Y, const int& Z) const
+	{
+		const unsigned int Packed = this->Gradients(X, Y, Z);
+
+		const float U = (float)(Packed & 0xff) / 127.5f - 1.0f;
+		const float V = (float)((Packed >> 8) & 0xff) / 127.5f - 1.0f;
+
+		Vec3f N(U, V, 1.0f - fabsf(U) - fabsf(V));
+
+		if (N[2] < 0.0f)
+		{
+			N[0] = (1.0f - fabsf(V)) * (U >= 0.0f ? 1.0f : -1.0f);
+			N[1] = (1.0f - fabsf(U)) * (V >= 0.0f ? 1.0f : -1.0f);
+		}
+
+		const float Magnitude = this->GradientMagnitudeRange.Min + (float)((Packed >> 16) & 0xff) * this->GradientMagnitudeRange.Extent / 255.0f;
+
+		return Normalize(N) * Magnitude;
+	}
+
+	HOST_DEVICE Vec3f GetLocalCoordinate(const Vec3f& XYZ) const
+	{
+		return (XYZ - this->BoundingBox.MinP) * this->InvSize * Vec3f(this->Resolution[0], this->Resolution[1], this->Resolution[2]);
+	}
+
 	BoundingBox					BoundingBox;
 	Vec3f						GradientDeltaX;
 	Vec3f						GradientDeltaY;
@@ -146,7 +304,16 @@ public:
 	Vec3f						Size;
 	Vec3f						InvSize;
 	float						MinStep;
+	Vec3i						Resolution;
+	Range						IntensityRange;
+	Range						GradientMagnitudeRange;
+	int							Histogram[NO_HISTOGRAM_BINS];
 	Buffer3D<unsigned short>	Voxels;
+	Buffer3D<unsigned short>	GradientMagnitudes;
+	bool						CacheGradients;
+	Buffer3D<unsigned int>		Gradients;
+	Buffer3D<Vec2f>				Macrocells;
+	SparseGrid					SparseGrid;
 };
 
 }
@@ -73,6 +73,17 @@ HOST_DEVICE_NI Vec3f GradientFiltered(const int& VolumeID, const Vec3f& P)
 	return Lerp(G0, Lerp(L0, L1, 0.5), 0.75);
 }
 
+/*
+	Gradient from the quantized gradient volume, which is only built for dense volumes that ask for it
+*/
+HOST_DEVICE_NI Vec3f GradientCached(const int& VolumeID, const Vec3f& P)
+{
+	if (gpVolumes[VolumeID].Gradients.GetNoElements() <= 0)
+		return GradientCD(VolumeID, P);
+
+	return gpVolumes[VolumeID].GetGradient(P);
+}
+
 HOST_DEVICE_NI Vec3f Gradient(const int& VolumeID, const Vec3f& P)
 {
 	switch (gpTracer->RenderSettings.Shading.GradientComputation)
@@ -80,6 +91,7 @@ HOST_DEVICE_NI Vec3f Gradient(const int& VolumeID, const Vec3f& P)
 		case Enums::ForwardDifferences:	return GradientFD(VolumeID, P);
 		case Enums::CentralDifferences:	return GradientCD(VolumeID, P);
 		case Enums::Filtered:			return GradientFiltered(VolumeID, P);
+		case Enums::Cached:				return GradientCached(VolumeID, P);
 	}
 
 	return GradientFD(VolumeID, P);
@@ -90,6 +102,35 @@ HOST_DEVICE_NI Vec3f NormalizedGradient(const int& VolumeID, const Vec3f& P)
 	return Normalize(Gradient(VolumeID, P));
 }
 
+/*
+	Advances T past the empty region of a sparse volume that R(T) lies in, returns false if R(T) is not in an empty region
+*/
+HOST_DEVICE_NI bool SkipEmptySpace(const int& VolumeID, const Ray& R, float& T)
+{
+	Vec3f Min, Max;
+
+	if (!gpVolumes[VolumeID].SparseGrid.GetEmptyBox(gpVolumes[VolumeID].GetLocalCoordinate(R(T)), Min, Max))
+		return false;
+
+	const Vec3f MinP = gpVolumes[VolumeID].BoundingBox.MinP + Min * gpVolumes[VolumeID].Spacing;
+	const Vec3f MaxP = gpVolumes[VolumeID].BoundingBox.MinP + Max * gpVolumes[VolumeID].Spacing;
+
+	float ExitT = FLT_MAX;
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (R.D[i] > 0.0f)
+			ExitT = fminf(ExitT, (MaxP[i] - R.O[i]) / R.D[i]);
+
+		if (R.D[i] < 0.0f)
+			ExitT = fminf(ExitT, (MinP[i] - R.O[i]) / R.D[i]);
+	}
+
+	T = fmaxf(ExitT, T) + RAY_EPS;
+
+	return true;
+}
+
 HOST_DEVICE_NI float GradientMagnitude(const int& VolumeID, const Vec3f& P)
 {
 	Vec3f Pts[3][2];
@@ -113,4 +154,25 @@ HOST_DEVICE_NI float GradientMagnitude(const int& VolumeID, const Vec3f& P)
 	return sqrtf(Sum);
 }
 
+/*
+	Nearest voxel value, used to look up labels, which can not be interpolated
+*/
+HOST_DEVICE_NI int GetLabelID(const int& VolumeID, const Vec3f& P)
+{
+	const Vec3f XYZ = gpVolumes[VolumeID].GetLocalCoordinate(P);
+
+	return gpVolumes[VolumeID].GetVoxel((int)(XYZ[0] + 0.5f), (int)(XYZ[1] + 0.5f), (int)(XYZ[2] + 0.5f));
+}
+
+/*
+	Gradient magnitude for classification, fetched from the cached gradient magnitude volume when there is one
+*/
+HOST_DEVICE_NI float GetGradientMagnitude(const int& VolumeID, const Vec3f& P)
+{
+	if (gpVolumes[VolumeID].GradientMagnitudes.GetNoElements() <= 0)
+		return GradientMagnitude(VolumeID, P);
+
+	return gpVolumes[VolumeID].GetGradientMagnitude(P);
+}
+
 }
@@ -0,0 +1,198 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "macros.cuh"
+#include "singlescattering.h"
+
+namespace ExposureRender
+{
+
+/*
+	Wavefront single scattering, the megakernel is split into generate, march, shade and shadow march
+	stages. Stages communicate through the structure of arrays queues in gpTracer->Wavefront, so the
+	threads of a warp only ever run one kind of work instead of diverging on the scatter event type
+*/
+DEVICE void PushHit(const int& PixelID, const ScatterEvent& SE)
+{
+	WavefrontQueues& Queues = gpTracer->Wavefront;
+
+	const int ID = atomicAdd(&Queues.Counters.Data[WavefrontQueues::HitQueue], 1);
+
+	Queues.SetVec3f(Queues.Hits.Data, WavefrontQueues::HitP, ID, SE.P);
+	Queues.SetVec3f(Queues.Hits.Data, WavefrontQueues::HitN, ID, SE.N);
+	Queues.SetVec3f(Queues.Hits.Data, WavefrontQueues::HitWo, ID, SE.Wo);
+
+	Queues.Hits.Data[WavefrontQueues::HitUV * Queues.Size + ID]			= SE.UV[0];
+	Queues.Hits.Data[(WavefrontQueues::HitUV + 1) * Queues.Size + ID]	= SE.UV[1];
+
+	Queues.HitIDs.Data[WavefrontQueues::HitPixelID * Queues.Size + ID]	= PixelID;
+	Queues.HitIDs.Data[WavefrontQueues::HitType * Queues.Size + ID]		= (int)SE.Type;
+	Queues.HitIDs.Data[WavefrontQueues::HitObjectID * Queues.Size + ID]	= SE.ObjectID;
+}
+
+DEVICE ScatterEvent GetHit(const int& ID, int& PixelID)
+{
+	const WavefrontQueues& Queues = gpTracer->Wavefront;
+
+	ScatterEvent SE((Enums::ScatterType)Queues.HitIDs.Data[WavefrontQueues::HitType * Queues.Size + ID]);
+
+	SE.Valid	= true;
+	SE.P		= Queues.GetVec3f(Queues.Hits.Data, WavefrontQueues::HitP, ID);
+	SE.N		= Queues.GetVec3f(Queues.Hits.Data, WavefrontQueues::HitN, ID);
+	SE.Wo		= Queues.GetVec3f(Queues.Hits.Data, WavefrontQueues::HitWo, ID);
+	SE.UV		= Vec2f(Queues.Hits.Data[WavefrontQueues::HitUV * Queues.Size + ID], Queues.Hits.Data[(WavefrontQueues::HitUV + 1) * Queues.Size + ID]);
+	SE.ObjectID	= Queues.HitIDs.Data[WavefrontQueues::HitObjectID * Queues.Size + ID];
+
+	PixelID = Queues.HitIDs.Data[WavefrontQueues::HitPixelID * Queues.Size + ID];
+
+	return SE;
+}
+
+template<int Variant>
+KERNEL void KrnlWavefrontGenerate()
+{
+	KERNEL_2D(gpTracer->FrameBuffer.Resolution[0], gpTracer->FrameBuffer.Resolution[1])
+
+	CRNG RNG(&gpTracer->FrameBuffer.RandomSeeds1(IDx, IDy), &gpTracer->FrameBuffer.RandomSeeds2(IDx, IDy));
+
+	CameraSample Sample(RNG);
+
+	Ray R;
+
+	SampleCamera<Variant>(gpTracer->Camera, R, IDx, IDy, Sample);
+
+	gpTracer->Wavefront.SetRay(IDk, R);
+	gpTracer->FrameBuffer.FrameEstimate(IDx, IDy) = ColorXYZAf(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+KERNEL void KrnlWavefrontMarch()
+{
+	KERNEL_2D(gpTracer->FrameBuffer.Resolution[0], gpTracer->FrameBuffer.Resolution[1])
+
+	CRNG RNG(&gpTracer->FrameBuffer.RandomSeeds1(IDx, IDy), &gpTracer->FrameBuffer.RandomSeeds2(IDx, IDy));
+
+	const Ray R = gpTracer->Wavefront.GetRay(IDk);
+
+	const ScatterEvent SE = SampleRay(R, RNG);
+
+	if (!SE.Valid)
+	{
+		ColorXYZf Le;
+
+		if (EnvironmentRadiance(R.D, Le))
+			gpTracer->FrameBuffer.FrameEstimate(IDx, IDy) = ColorXYZAf(Le[0], Le[1], Le[2], 1.0f);
+
+		return;
+	}
+
+	if (SE.Type == Enums::Light)
+	{
+		gpTracer->FrameBuffer.FrameEstimate(IDx, IDy) = ColorXYZAf(SE.Le[0], SE.Le[1], SE.Le[2], 1.0f);
+		return;
+	}
+
+	gpTracer->FrameBuffer.FrameEstimate(IDx, IDy)[3] = 1.0f;
+
+	PushHit(IDk, SE);
+}
+
+template<int Variant>
+KERNEL void KrnlWavefrontShade()
+{
+	KERNEL_1D(gpTracer->Wavefront.Counters.Data[WavefrontQueues::HitQueue])
+
+	int PixelID = 0;
+
+	ScatterEvent SE = GetHit(IDk, PixelID);
+
+	const int X = PixelID % gpTracer->FrameBuffer.Resolution[0];
+	const int Y = PixelID / gpTracer->FrameBuffer.Resolution[0];
+
+	CRNG RNG(&gpTracer->FrameBuffer.RandomSeeds1(X, Y), &gpTracer->FrameBuffer.RandomSeeds2(X, Y));
+
+	LightingSample Sample(RNG);
+
+	ShadowRay Shadow;
+
+	const ColorXYZf Ld = SampleOneLight<Variant>(SE, RNG, Sample, Shadow);
+
+	ColorXYZAf& Estimate = gpTracer->FrameBuffer.FrameEstimate(X, Y);
+
+	for (int i = 0; i < 3; i++)
+		Estimate[i] += Ld[i];
+
+	if (!Shadow.Valid)
+		return;
+
+	const int ShadowID = atomicAdd(&gpTracer->Wavefront.Counters.Data[WavefrontQueues::ShadowQueue], 1);
+
+	gpTracer->Wavefront.SetShadow(ShadowID, PixelID, Shadow);
+}
+
+template<int Variant>
+KERNEL void KrnlWavefrontShadowMarch()
+{
+	KERNEL_1D(gpTracer->Wavefront.Counters.Data[WavefrontQueues::ShadowQueue])
+
+	int PixelID = 0;
+
+	const ShadowRay Shadow = gpTracer->Wavefront.GetShadow(IDk, PixelID);
+
+	const int X = PixelID % gpTracer->FrameBuffer.Resolution[0];
+	const int Y = PixelID / gpTracer->FrameBuffer.Resolution[0];
+
+	CRNG RNG(&gpTracer->FrameBuffer.RandomSeeds1(X, Y), &gpTracer->FrameBuffer.RandomSeeds2(X, Y));
+
+	if (!Visible<Variant>(Shadow.From, Shadow.To, RNG))
+		return;
+
+	ColorXYZAf& Estimate = gpTracer->FrameBuffer.FrameEstimate(X, Y);
+
+	for (int i = 0; i < 3; i++)
+		Estimate[i] += Shadow.Ld[i];
+}
+
+/*
+	The queue sizes are only known on the device, so the shade and shadow march stages are launched
+	over all pixels and the threads beyond the queue size exit immediately
+*/
+template<int Variant>
+void RenderWavefront(Tracer& Tracer, const char* pTitle)
+{
+	Tracer.Wavefront.Reset();
+
+	const int NoPixels = Tracer.FrameBuffer.Resolution[0] * Tracer.FrameBuffer.Resolution[1];
+
+	{
+		LAUNCH_DIMENSIONS(Tracer.FrameBuffer.Resolution[0], Tracer.FrameBuffer.Resolution[1], 1, 8, 16, 1)
+
+		LAUNCH_CUDA_KERNEL_TIMED((KrnlWavefrontGenerate<Variant><<<GridDim, BlockDim>>>()), "Wavefront Generate")
+		LAUNCH_CUDA_KERNEL_TIMED((KrnlWavefrontMarch<<<GridDim, BlockDim>>>()), "Wavefront March")
+	}
+
+	{
+		LAUNCH_DIMENSIONS(NoPixels, 1, 1, 128, 1, 1)
+
+		LAUNCH_CUDA_KERNEL_TIMED((KrnlWavefrontShade<Variant><<<GridDim, BlockDim>>>()), pTitle)
+		LAUNCH_CUDA_KERNEL_TIMED((KrnlWavefrontShadowMarch<Variant><<<GridDim, BlockDim>>>()), "Wavefront Shadow March")
+	}
+}
+
+}
@@ -0,0 +1,214 @@
+/*
+    Exposure Render: An interactive photo-realistic volume rendering framework
+    Copyright (C) 2011 Thomas Kroes
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "buffer2d.h"
+#include "ray.h"
+#include "color.h"
+
+namespace ExposureRender
+{
+
+/*
+	Shadow ray that is traced in a separate stage, Ld is the unoccluded contribution it carries
+*/
+class ShadowRay
+{
+public:
+	HOST_DEVICE ShadowRay() :
+		Valid(false),
+		From(),
+		To(),
+		Ld()
+	{
+	}
+
+	HOST_DEVICE ShadowRay(const Vec3f& From, const Vec3f& To, const ColorXYZf& Ld) :
+		Valid(true),
+		From(From),
+		To(To),
+		Ld(Ld)
+	{
+	}
+
+	bool		Valid;
+	Vec3f		From;
+	Vec3f		To;
+	ColorXYZf	Ld;
+};
+
+/*
+	Structure of arrays queues for the wavefront renderer. Each row of a queue holds one scalar
+	component for all entries, so neighbouring threads read and write neighbouring addresses
+*/
+class WavefrontQueues
+{
+public:
+	enum Queue
+	{
+		HitQueue = 0,
+		ShadowQueue,
+		NoQueues
+	};
+
+	enum RayRow
+	{
+		RayO		= 0,
+		RayD		= 3,
+		RayMinT		= 6,
+		RayMaxT		= 7,
+		NoRayRows	= 8
+	};
+
+	enum HitRow
+	{
+		HitP		= 0,
+		HitN		= 3,
+		HitWo		= 6,
+		HitUV		= 9,
+		NoHitRows	= 11
+	};
+
+	enum HitIDRow
+	{
+		HitPixelID	= 0,
+		HitType		= 1,
+		HitObjectID	= 2,
+		NoHitIDRows	= 3
+	};
+
+	enum ShadowRow
+	{
+		ShadowFrom		= 0,
+		ShadowTo		= 3,
+		ShadowLd		= 6,
+		NoShadowRows	= 9
+	};
+
+	HOST WavefrontQueues() :
+		Size(0),
+		Rays(Enums::Device, "Wavefront Rays"),
+		Hits(Enums::Device, "Wavefront Hits"),
+		HitIDs(Enums::Device, "Wavefront Hit IDs"),
+		Shadows(Enums::Device, "Wavefront Shadow Rays"),
+		ShadowIDs(Enums::Device, "Wavefront Shadow Ray IDs"),
+		Counters(Enums::Device, "Wavefront Queue Sizes")
+	{
+	}
+
+	HOST WavefrontQueues& WavefrontQueues::operator = (const WavefrontQueues& Other)
+	{
+		this->Size		= Other.Size;
+		this->Rays		= Other.Rays;
+		this->Hits		= Other.Hits;
+		this->HitIDs	= Other.HitIDs;
+		this->Shadows	= Other.Shadows;
+		this->ShadowIDs	= Other.ShadowIDs;
+		this->Counters	= Other.Counters;
+
+		return *this;
+	}
+
+	HOST void Resize(const Vec2i& Resolution)
+	{
+		this->Size = Resolution[0] * Resolution[1];
+
+		this->Rays.Resize(Vec2i(this->Size, NoRayRows));
+		this->Hits.Resize(Vec2i(this->Size, NoHitRows));
+		this->HitIDs.Resize(Vec2i(this->Size, NoHitIDRows));
+		this->Shadows.Resize(Vec2i(this->Size, NoShadowRows));
+		this->ShadowIDs.Resize(Vec2i(this->Size, 1));
+		this->Counters.Resize(Vec2i(NoQueues, 1));
+	}
+
+	HOST void Free(void)
+	{
+		this->Size = 0;
+
+		this->Rays.Free();
+		this->Hits.Free();
+		this->HitIDs.Free();
+		this->Shadows.Free();
+		this->ShadowIDs.Free();
+		this->Counters.Free();
+	}
+
+	HOST void Reset(void)
+	{
+		this->Counters.Reset();
+	}
+
+	HOST_DEVICE void SetRay(const int& ID, const Ray& R)
+	{
+		this->SetVec3f(this->Rays.Data, RayO, ID, R.O);
+		this->SetVec3f(this->Rays.Data, RayD, ID, R.D);
+
+		this->Rays.Data[RayMinT * this->Size + ID] = R.MinT;
+		this->Rays.Data[RayMaxT * this->Size + ID] = R.MaxT;
+	}
+
+	HOST_DEVICE Ray GetRay(const int& ID) const
+	{
+		return Ray(this->GetVec3f(this->Rays.Data, RayO, ID), this->GetVec3f(this->Rays.Data, RayD, ID), this->Rays.Data[RayMinT * this->Size + ID], this->Rays.Data[RayMaxT * this->Size + ID]);
+	}
+
+	HOST_DEVICE void SetShadow(const int& ID, const int& PixelID, const ShadowRay& Shadow)
+	{
+		this->SetVec3f(this->Shadows.Data, ShadowFrom, ID, Shadow.From);
+		this->SetVec3f(this->Shadows.Data, ShadowTo, ID, Shadow.To);
+
+		for (int i = 0; i < 3; i++)
+			this->Shadows.Data[(ShadowLd + i) * this->Size + ID] = Shadow.Ld[i];
+
+		this->ShadowIDs.Data[ID] = PixelID;
+	}
+
+	HOST_DEVICE ShadowRay GetShadow(const int& ID, int& PixelID) const
+	{
+		ColorXYZf Ld;
+
+		for (int i = 0; i < 3; i++)
+			Ld[i] = this->Shadows.Data[(ShadowLd + i) * this->Size + ID];
+
+		PixelID = this->ShadowIDs.Data[ID];
+
+		return ShadowRay(this->GetVec3f(this->Shadows.Data, ShadowFrom, ID), this->GetVec3f(this->Shadows.Data, ShadowTo, ID), Ld);
+	}
+
+	HOST_DEVICE void SetVec3f(float* pRows, const int& Row, const int& ID, const Vec3f& V)
+	{
+		for (int i = 0; i < 3; i++)
+			pRows[(Row + i) * this->Size + ID] = V[i];
+	}
+
+	HOST_DEVICE Vec3f GetVec3f(const float* pRows, const int& Row, const int& ID) const
+	{
+		return Vec3f(pRows[Row * this->Size + ID], pRows[(Row + 1) * this->Size + ID], pRows[(Row + 2) * this->Size + ID]);
+	}
+
+	int					Size;
+	Buffer2D<float>		Rays;
+	Buffer2D<float>		Hits;
+	Buffer2D<int>		HitIDs;
+	Buffer2D<float>		Shadows;
+	Buffer2D<int>		ShadowIDs;
+	Buffer2D<int>		Counters;
+};
+
+}
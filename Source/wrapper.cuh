@@ -92,13 +92,38 @@ template<class T> static inline void MemCopyDeviceToDeviceSymbol(T* pDevice, con
 	Cuda::ThreadSynchronize();
 }
 
-template<class T> static inline void MemCopyHostToDevice(T* pHost, T* pDevice, int Num = 1)
+template<class T> static inline void MemCopyHostToDevice(const T* pHost, T* pDevice, int Num = 1)
 {
 	Cuda::ThreadSynchronize();
 	HandleCudaError(cudaMemcpy(pDevice, pHost, Num * sizeof(T), cudaMemcpyHostToDevice), "cudaMemcpy");
 	Cuda::ThreadSynchronize();
 }
 
+template<class T> static inline void MemCopyHostToDeviceAsync(T* pHost, T* pDevice, int Num, cudaStream_t Stream)
+{
+	HandleCudaError(cudaMemcpyAsync(pDevice, pHost, Num * sizeof(T), cudaMemcpyHostToDevice, Stream), "cudaMemcpyAsync");
+}
+
+template<class T> static inline void MemCopyDeviceToHostAsync(T* pDevice, T* pHost, int Num, cudaStream_t Stream)
+{
+	HandleCudaError(cudaMemcpyAsync(pHost, pDevice, Num * sizeof(T), cudaMemcpyDeviceToHost, Stream), "cudaMemcpyAsync");
+}
+
+template<class T> static inline void MemSetAsync(T* pDevicePointer, const int Value, int Num, cudaStream_t Stream)
+{
+	HandleCudaError(cudaMemsetAsync((void*)pDevicePointer, Value, (size_t)(Num * sizeof(T)), Stream), "cudaMemsetAsync");
+}
+
+template<class T> static inline void HostRegister(T* pHost, int Num)
+{
+	HandleCudaError(cudaHostRegister((void*)pHost, Num * sizeof(T), cudaHostRegisterDefault), "cudaHostRegister");
+}
+
+template<class T> static inline void HostUnregister(T* pHost)
+{
+	HandleCudaError(cudaHostUnregister((void*)pHost), "cudaHostUnregister");
+}
+
 template<class T> static inline void MemCopyDeviceToHost(T* pDevice, T* pHost, int Num = 1)
 {
 	Cuda::ThreadSynchronize();
@@ -113,6 +138,40 @@ template<class T> static inline void MemCopyDeviceToDevice(T* pDeviceSource, T*
 	Cuda::ThreadSynchronize();
 }
 
+template<class T> static inline void MemCopyHostToDeviceBox(T* pHost, T* pDevice, const int DeviceResolution[3], const int Offset[3], const int Extent[3])
+{
+	cudaMemcpy3DParms Parms = { 0 };
+
+	Parms.srcPtr	= make_cudaPitchedPtr((void*)pHost, Extent[0] * sizeof(T), Extent[0], Extent[1]);
+	Parms.dstPtr	= make_cudaPitchedPtr((void*)pDevice, DeviceResolution[0] * sizeof(T), DeviceResolution[0], DeviceResolution[1]);
+	Parms.dstPos	= make_cudaPos(Offset[0] * sizeof(T), Offset[1], Offset[2]);
+	Parms.extent	= make_cudaExtent(Extent[0] * sizeof(T), Extent[1], Extent[2]);
+	Parms.kind		= cudaMemcpyHostToDevice;
+
+	Cuda::ThreadSynchronize();
+	HandleCudaError(cudaMemcpy3D(&Parms), "cudaMemcpy3D");
+	Cuda::ThreadSynchronize();
+}
+
+static inline void CreateStream(cudaStream_t& Stream)
+{
+	HandleCudaError(cudaStreamCreateWithFlags(&Stream, cudaStreamNonBlocking), "cudaStreamCreateWithFlags");
+}
+
+static inline void DestroyStream(cudaStream_t& Stream)
+{
+	if (Stream == NULL)
+		return;
+
+	HandleCudaError(cudaStreamDestroy(Stream), "cudaStreamDestroy");
+	Stream = NULL;
+}
+
+static inline void StreamSynchronize(cudaStream_t Stream)
+{
+	HandleCudaError(cudaStreamSynchronize(Stream), "cudaStreamSynchronize");
+}
+
 static inline void FreeArray(cudaArray*& pCudaArray)
 {
 	Cuda::ThreadSynchronize();